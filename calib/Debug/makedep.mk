@@ -6,12 +6,30 @@ atmel_start.c
 
 calibRC.c
 
+clock_comp.c
+
+clock_target.c
+
 driver_isr.c
 
+examples\src\cpuint_latency_example.c
+
 examples\src\pwm_basic_example.c
 
+examples\src\scheduler_example.c
+
+examples\src\soft_timer_example.c
+
 main.c
 
+profile.c
+
+recal_policy.c
+
+scheduler.c
+
+soft_timer.c
+
 src\bod.c
 
 src\clkctrl.c
@@ -20,10 +38,20 @@ src\cpuint.c
 
 src\driver_init.c
 
+src\init_table.c
+
 src\protected_io.S
 
 src\pwm_basic.c
 
+src\pwm_hires.c
+
+src\pwm_split.c
+
+src\pwm_stream.c
+
+src\pwm_tcd.c
+
 src\rtc.c
 
 src\slpctrl.c
@@ -8,40 +8,79 @@
 #include "calibRC.h"
 #include <avr/cpufunc.h>
 #include <atmel_start.h>
+#include <ccp.h>
+#include <clkctrl.h>
+#include "profile.h"
 
-unsigned char defaultCalibValueAtmel;
-//! Holds the number of neighbors searched
-unsigned char neighborsSearched;
-//! The binary search step size
-unsigned char calStep;
-//! The lowest difference between desired and measured counter value
-unsigned int bestCountDiff = 0xFFFF;
-//! The OSCCALR value corresponding to the bestCountDiff
-unsigned char bestOSCCAL;
-//! The desired counter value
-unsigned int countVal;
-//! Calibration status
-unsigned int calibration;
-//! Stores the direction of the binary step (-1 or 1)
-signed char sign;
-
-signed char success_flag = -1;
+//! Context used by InitCalibRc() and CalibInternalRc()
+calib_context_t calibDefault;
+//! Set by InitCalibRc() once the 32kHz crystal is stable
+unsigned char xtalReady;
+//! Time InitCalibRc() waited for the crystal, in ms: too long for the cycle profiler
+unsigned int xtalStartupMs;
+//! Notified of the measured clock after each calibration, in registration order
+calib_clock_cb_t clockCallbacks[CALIB_CLOCK_CALLBACKS];
+//! Measured / target CPU clock of calibDefault in Q16, CALIB_Q16_ONE until measured
+volatile unsigned long calibCorrection = CALIB_Q16_ONE;
 
 //Functions used
-signed char CalibrateInternalRc(void);
+signed char CalibrateSearch(calib_context_t *ctx);
 unsigned int Counter(void);
-void NeighborSearch(void);
-void _delay_5us(void);
+unsigned int CounterTicks(unsigned int ticks);
+void NeighborSearch(calib_context_t *ctx);
+unsigned int CoarseSearch(calib_context_t *ctx, unsigned int count);
+signed int CalibCodesOff(calib_context_t *ctx, unsigned int count);
+unsigned char CalibTrimAdd(unsigned char osccal, signed int codes);
 
-void InitCalibRc(void)
+/*! \brief Prepares the calibration
+*
+* The target is the nominal OSC20M frequency of the FREQSEL fuse divided
+* by the running MCLKCTRLB prescaler, so the same build calibrates units
+* fused for 16 MHz and for 20 MHz. Waits for the 32kHz crystal started by CLKCTRL_init() to become stable.
+* Returns -1 if it does not start within XTAL_STARTUP_TIMEOUT_MS, in which
+* case CalibInternalRc() refuses to run and the oscillator keeps its factory value.
+*/
+signed char InitCalibRc(void)
 {
-	// Sets initial stepsize and sets calibration state to "running"
-	calStep = INITIAL_STEP;
-	calibration = RUNNING;
-	countVal = ((EXTERNAL_TICKS * CALIBRATION_FREQUENCY) / (XTAL_FREQUENCY * LOOP_CYCLES));
+	PROFILE_BEGIN(PROFILE_INIT_CALIB);
+	InitCalibContext(&calibDefault, CLKCTRL_osc20m_nominal_hz() / CLKCTRL_prescaler());
+	PROFILE_END(PROFILE_INIT_CALIB);
 	
-	while (STATUS_TIMER_REGISTER > 0);					// Wait until async timer is updated  (Async Status reg. busy flags).
-	defaultCalibValueAtmel = OSCCALR;
+	/* Hundreds of ms, waited 1 ms at a time to time it */
+	xtalReady = 0;
+	for (xtalStartupMs = 0; xtalStartupMs < XTAL_STARTUP_TIMEOUT_MS; xtalStartupMs++) {
+		if (CLKCTRL_wait_xosc32k_stable(1) == 0) {
+			xtalReady = 1;
+			break;
+		}
+	}
+	if (xtalReady)
+	{
+		while (STATUS_TIMER_REGISTER > 0);				// Wait until async timer is updated  (Async Status reg. busy flags).
+	}
+	return xtalReady ? 0 : -1;
+}
+
+/*! \brief Prepares a calibration context
+*
+* \param ctx       Context to initialize
+* \param frequency CPU frequency the oscillator is calibrated to, at the
+*                  current prescaler
+*/
+void InitCalibContext(calib_context_t *ctx, unsigned long frequency)
+{
+	// Sets initial stepsize and sets calibration state to "running"
+	ctx->calStep = INITIAL_STEP;
+	CALIB_STATE(ctx) = RUNNING;
+	ctx->prescaler = CLKCTRL_prescaler();
+	ctx->oscFrequency = frequency * ctx->prescaler;
+	ctx->countVal = ((EXTERNAL_TICKS * frequency) / (XTAL_FREQUENCY * LOOP_CYCLES));
+	ctx->bestCountDiff = 0xFFFF;
+	ctx->measuredCount = 0;
+	ctx->defaultCalibValueAtmel = OSCCALR;
+	ctx->success_flag = -1;
+	ctx->vddBand = CALIB_BAND_UNKNOWN;
+	ctx->bandValid = 0;
 }
 
 /*! \brief Program entry point.
@@ -53,98 +92,431 @@ void InitCalibRc(void)
 */
 
 signed char CalibInternalRc(void){
-	return CalibrateInternalRc();								// Calibrates to selected frequency
+	return CalibrateContext(&calibDefault);						// Calibrates to selected frequency
+}
+
+/*! \brief Register a function notified of the measured clock
+*
+* Called at the end of every calibration that measured the oscillator and
+* on every clock switch, so drivers (e.g. PWM_0_clock_changed()) can
+* rescale their timing.
+*
+* \return 0, or -1 if CALIB_CLOCK_CALLBACKS are already registered
+*/
+signed char CalibAddClockCallback(calib_clock_cb_t cb){
+	unsigned char i;
+	
+	for (i = 0; i < CALIB_CLOCK_CALLBACKS; i++)
+	{
+		if (clockCallbacks[i] == 0 || clockCallbacks[i] == cb)
+		{
+			clockCallbacks[i] = cb;
+			return 0;
+		}
+	}
+	return -1;
+}
+
+/*! \brief Tells every registered driver the CPU now runs at \a frequency
+*/
+void CalibNotifyClock(unsigned long frequency){
+	unsigned char i;
+	
+	for (i = 0; i < CALIB_CLOCK_CALLBACKS && clockCallbacks[i]; i++)
+	{
+		clockCallbacks[i](frequency);
+	}
+}
+
+/*! \brief The CPU clock measured by the last calibration of \a ctx
+*
+* \return Frequency in Hz, 0 if the oscillator was not measured
+*/
+unsigned long CalibMeasuredFrequency(calib_context_t *ctx){
+	return ((unsigned long)ctx->measuredCount * (XTAL_FREQUENCY * LOOP_CYCLES)) / EXTERNAL_TICKS;
 }
 
 /*! \brief Calibration function
 *
 * Performs the calibration according to calibration method chosen.
 * Compares different calibration results in order to achieve optimal results.
+* All state lives in \a ctx, so several contexts (e.g. different target
+* frequencies) can be kept side by side.
+*
+*/
+signed char CalibrateContext(calib_context_t *ctx){
+	signed char ret;
+
+	CalibFollowPrescaler(ctx);
+#ifdef CALIBRATION_COMPENSATE_ONLY
+	ret = CalibMeasureError(ctx);							// Any band, nothing is written
+#else
+	if (ctx->vddBand == 0) return -1;						// Too close to brown-out to search
+	
+	ret = CalibrateSearch(ctx);
+#endif
+	if (ret == 1 && ctx->vddBand < CALIB_VDD_BANDS)
+	{
+		ctx->bandOSCCAL[ctx->vddBand] = OSCCALR;				// Reused when the supply comes back to this band
+		ctx->bandCount[ctx->vddBand] = ctx->measuredCount;
+		ctx->bandValid |= 1 << ctx->vddBand;
+	}
+	if (ctx->measuredCount)
+	{
+		CalibNotifyClock(CalibMeasuredFrequency(ctx));
+	}
+	return ret;
+}
+
+/*! \brief Follows a change of the CLK_PER prescaler
+*
+* The target is kept as an OSC20M frequency, so when MCLKCTRLB was changed
+* since the last call the trim codes stay valid and only the counts are
+* rescaled. Called by CalibrateContext() and CalibVerify().
+*/
+void CalibFollowPrescaler(calib_context_t *ctx){
+	unsigned char prescaler = CLKCTRL_prescaler();
+	unsigned char i;
+	
+	if (prescaler == ctx->prescaler) return;
+	
+	ctx->countVal = ((EXTERNAL_TICKS * (ctx->oscFrequency / prescaler)) / (XTAL_FREQUENCY * LOOP_CYCLES));
+	ctx->measuredCount = (unsigned long)ctx->measuredCount * ctx->prescaler / prescaler;
+	for (i = 0; i < CALIB_VDD_BANDS; i++)
+	{
+		ctx->bandCount[i] = (unsigned long)ctx->bandCount[i] * ctx->prescaler / prescaler;
+	}
+	ctx->prescaler = prescaler;
+}
+
+/*! \brief Calibrates \a ctx to another OSC20M frequency
+*
+* Moves between the 16 and 20 MHz derived targets (e.g. 4 MHz and 5 MHz
+* with the /4 prescaler) whatever the FREQSEL fuse says, within the reach
+* of the trim. The per-band codes belong to the old target and are
+* dropped. The clock callbacks are notified as after any calibration.
+*
+* \param oscFrequency New OSC20M target in Hz, e.g. 16000000 or 20000000
 *
+* \return Result of CalibrateContext()
 */
-signed char CalibrateInternalRc(void){
+signed char CalibSwitchOscillator(calib_context_t *ctx, unsigned long oscFrequency){
+	CalibFollowPrescaler(ctx);
+	ctx->oscFrequency = oscFrequency;
+	ctx->countVal = ((EXTERNAL_TICKS * (oscFrequency / ctx->prescaler)) / (XTAL_FREQUENCY * LOOP_CYCLES));
+	ctx->bandValid = 0;
+	ctx->measuredCount = 0;
+	return CalibrateContext(ctx);
+}
+
+/*! \brief Switches to the trim code of a supply band
+*
+* Called when the supply moved to \a band. A code calibrated earlier in
+* that band is written at once, without a search, and the clock callbacks
+* are notified. In band 0 (close to brown-out) the factory value is
+* restored: it is the one guaranteed at any VDD, and CalibrateContext()
+* refuses to search until the supply comes back.
+* Cheap enough for an interrupt, but not while \a ctx is being calibrated.
+*
+* \return 1 if a code was applied, 0 if the band needs a calibration
+*/
+signed char CalibSetVddBand(calib_context_t *ctx, unsigned char band){
+	ctx->vddBand = band;
+#ifdef CALIBRATION_COMPENSATE_ONLY
+	return 0;												// No stored codes, measure again
+#else
+	if (band == 0)
+	{
+		ccp_write_io_inline(OSCCALR, ctx->defaultCalibValueAtmel);
+		NOP();
+		ctx->measuredCount = 0;								// Not measured at this supply
+		return 1;
+	}
+	if (band >= CALIB_VDD_BANDS || !(ctx->bandValid & (1 << band))) return 0;
+	
+	if (OSCCALR != ctx->bandOSCCAL[band])
+	{
+		ccp_write_io_inline(OSCCALR, ctx->bandOSCCAL[band]);
+		NOP();
+	}
+	ctx->measuredCount = ctx->bandCount[band];
+	CalibNotifyClock(CalibMeasuredFrequency(ctx));
+	return 1;
+#endif
+}
+
+/*! \brief The calibration search itself, see CalibrateContext()
+*/
+signed char CalibrateSearch(calib_context_t *ctx){
 	unsigned int count;
 	unsigned int countDiff;
-	neighborsSearched = 0;
+	CALIB_NEIGHBORS(ctx) = 0;
+	ctx->measuredCount = 0;
 	
-	success_flag = -1;
+	ctx->success_flag = -1;
+	if (!xtalReady) return ctx->success_flag;
 	
 	unsigned char i = 0;
-	calibration = FINISHED;
+	CALIB_STATE(ctx) = RUNNING;
 	
+	count = Counter();
 	while(i++ < COUNT_RETRY)
 	{
+		unsigned int prev = count;
 		count = Counter();
-		countDiff = ABS((signed int)count-(signed int)countVal);
-		if (countDiff < (countVal * ACCURACY_DEFAULT))
+		countDiff = ABS((signed int)count-(signed int)prev);
+		if (countDiff > (prev * ACCURACY_DEFAULT))
 		{
-			break;
-		}		
+			continue;										// Two counts in a row must agree, else one was disturbed
+		}
+		signed int codes = CalibCodesOff(ctx, count);
+		unsigned char trim = OSCCALR & DEVICE_TRIM_MASK;
+		if (codes <= 0 ? trim >= -codes - 2 : DEVICE_TRIM_MASK - trim >= codes - 2)
+		{
+			break;											// The trim range can reach the target from here
+		}
 	}
 	
-	if (i >= COUNT_RETRY) return success_flag;
+	ctx->measuredCount = count;								// OSCCALR is unchanged so far
+	if (i >= COUNT_RETRY) return ctx->success_flag;
+	
+	countDiff = ABS((signed int)count-(signed int)ctx->countVal);
+	ctx->bestCountDiff = countDiff;
+	ctx->bestCount = count;
+	ctx->bestOSCCAL = OSCCALR;
+	
+	count = CoarseSearch(ctx, count);
+	ctx->measuredCount = count;								// Of the OSCCALR the coarse search left
 	
-	if (count < countVal)
+	if (count < ctx->countVal)
 	{
-		sign = 1;
+		CALIB_SIGN(ctx) = 1;
 	}
-	else if (count > countVal)
+	else if (count > ctx->countVal)
 	{
-		sign = -1;
+		CALIB_SIGN(ctx) = -1;
 	} else
 	{
-		success_flag = 0;
-		sign = 0;
-		calibration = FINISHED;
+		ctx->success_flag = 1;							// Already exact, nothing to search
+		CALIB_SIGN(ctx) = 0;
+		CALIB_STATE(ctx) = FINISHED;
+		return ctx->success_flag;
 	}
 	
-	bestCountDiff = countDiff;
-	bestOSCCAL = OSCCALR;
-	NeighborSearch();
+	NeighborSearch(ctx);
 	
-	while(calibration == RUNNING){
+	while(CALIB_STATE(ctx) == RUNNING){
 		count = Counter();                                          // Counter returns the count value after external ticks on XTAL		
-		countDiff = ABS((signed int)count-(signed int)countVal);
-		if (countDiff < bestCountDiff)						// Store OSCCALR if higher accuracy is achieved
+		countDiff = ABS((signed int)count-(signed int)ctx->countVal);
+		if (countDiff < ctx->bestCountDiff)					// Store OSCCALR if higher accuracy is achieved
 		{
-			bestCountDiff = countDiff;
-			bestOSCCAL = OSCCALR;
+			ctx->bestCountDiff = countDiff;
+			ctx->bestCount = count;
+			ctx->bestOSCCAL = OSCCALR;
 		}
-		NeighborSearch();
+		NeighborSearch(ctx);
 	}
 
-	return success_flag;
+	return ctx->success_flag;
+}
+
+/*! \brief How many trim codes the oscillator is away from the target
+*
+* Estimated with DEVICE_TRIM_STEP_PERMILLE, so only good for sizing steps.
+*
+* \return Codes to add to OSCCALR, positive if the clock is slow
+*/
+signed int CalibCodesOff(calib_context_t *ctx, unsigned int count){
+	return ((signed long)ctx->countVal - (signed long)count) * 1000
+		/ ((signed long)ctx->countVal * DEVICE_TRIM_STEP_PERMILLE);
+}
+
+/*! \brief Adds \a codes to the trim field of \a osccal
+*
+* Saturates at both ends of the DEVICE_TRIM_BITS field and keeps the bits
+* above it, so a step never wraps around or writes a reserved bit.
+*/
+unsigned char CalibTrimAdd(unsigned char osccal, signed int codes){
+	signed int trim = (osccal & DEVICE_TRIM_MASK) + codes;
+	
+	if (trim < 0) trim = 0;
+	if (trim > DEVICE_TRIM_MASK) trim = DEVICE_TRIM_MASK;
+	return (osccal & ~DEVICE_TRIM_MASK) | trim;
+}
+
+/*! \brief Range-aware coarse search
+*
+* Jumps by the number of codes the error amounts to until it is within two
+* codes, the neighbor search then finishes. Needed by the 7-bit trims of
+* the 2-series: a 16 or 20 MHz factory value can be tens of codes away from
+* the target, e.g. when overclocking to 24-32 MHz. Stops at the end of the
+* trim range. The best code seen is kept in \a ctx.
+*
+* \param count Counter value of the current OSCCALR
+*
+* \return Counter value of the OSCCALR left in place
+*/
+unsigned int CoarseSearch(calib_context_t *ctx, unsigned int count){
+	unsigned char i = OSCCAL_RESOLUTION;					// Bound on the jumps, one or two are usual
+	unsigned int countDiff;
+	unsigned char next;
+	signed int codes;
+	
+	while (i--)
+	{
+		codes = CalibCodesOff(ctx, count);
+		if (codes >= -2 && codes <= 2) break;
+		next = CalibTrimAdd(OSCCALR, codes);
+		if (next == OSCCALR) break;							// At the end of the range
+		ccp_write_io_inline(OSCCALR, next);
+		NOP();
+		count = Counter();
+		countDiff = ABS((signed int)count-(signed int)ctx->countVal);
+		if (countDiff < ctx->bestCountDiff)
+		{
+			ctx->bestCountDiff = countDiff;
+			ctx->bestCount = count;
+			ctx->bestOSCCAL = OSCCALR;
+		}
+	}
+	return count;
+}
+
+/*! \brief Measures the clock error without touching OSCCALR
+*
+* The measurement of a calibration, used alone by CALIBRATION_COMPENSATE_ONLY.
+* For calibDefault the ratio measured / target clock is published in
+* calibCorrection.
+*
+* \return 1 if measured, -1 without crystal or if no measurement was stable
+*/
+signed char CalibMeasureError(calib_context_t *ctx){
+	unsigned int count;
+	unsigned int countDiff;
+	unsigned char i = 0;
+	
+	ctx->success_flag = -1;
+	if (!xtalReady) return ctx->success_flag;
+	
+	count = Counter();
+	while(i++ < COUNT_RETRY)								// Two counts in a row must agree, an interrupt shortens one
+	{
+		ctx->measuredCount = count;
+		count = Counter();
+		countDiff = ABS((signed int)count-(signed int)ctx->measuredCount);
+		if (countDiff <= 1)
+		{
+			break;
+		}
+	}
+	if (i >= COUNT_RETRY)
+	{
+		ctx->measuredCount = 0;
+		return ctx->success_flag;
+	}
+	
+	if (ctx == &calibDefault)
+	{
+		unsigned long correction = ((unsigned long)ctx->measuredCount << 16) / ctx->countVal;
+		ENTER_CRITICAL(W);
+		calibCorrection = correction;
+		EXIT_CRITICAL(W);
+	}
+	ctx->success_flag = 1;
+	return ctx->success_flag;
+}
+
+/*! \brief Scales a duration or a count computed for the target clock
+*
+* \return \a value * calibCorrection, e.g. the cycles a nominal delay really
+*         needs or the BAUD value at the real clock
+*/
+unsigned long CalibCorrect(unsigned long value){
+	signed long delta;
+	
+	ENTER_CRITICAL(R);
+	delta = (signed long)calibCorrection - (signed long)CALIB_Q16_ONE;
+	EXIT_CRITICAL(R);
+	
+	// value + value * delta, split to stay in 32 bits for any value and |delta| < 0.5
+	return value + (value >> 16) * delta + (((signed long)(value & 0xFFFF) * delta) >> 16);
+}
+
+/*! \brief Checks the calibration with a short measurement
+*
+* Counts over \a ticks crystal ticks only, much cheaper than a calibration
+* (32 ticks ~ 1ms), with a resolution of about 1 / (ticks * count per tick).
+*
+* \param ctx   Context giving the target frequency
+* \param ticks Measurement window in 32kHz ticks, 1 to EXTERNAL_TICKS
+*
+* \return Clock error in 1/1000, positive if the clock is fast, 0 without crystal
+*/
+signed int CalibVerify(calib_context_t *ctx, unsigned int ticks)
+{
+	unsigned long expected;
+	unsigned long count;
+
+	if (!xtalReady) return 0;
+	CalibFollowPrescaler(ctx);
+	expected = ((unsigned long)ctx->countVal * ticks) / EXTERNAL_TICKS;
+	count = CounterTicks(ticks);
+
+	return ((signed long)count - (signed long)expected) * 1000 / (signed long)expected;
+}
+
+/*! \brief Counts over the standard EXTERNAL_TICKS window, see CounterTicks()
+*/
+unsigned int Counter(void){
+	return CounterTicks(EXTERNAL_TICKS);
 }
 
 /*! \brief The Counter function
 *
 * This function increments a counter for a given ammount of ticks on
 * on the external watch crystal.
+* Interrupts are off during the measurement: an interrupt would steal loop
+* cycles, and a CNT read in an ISR corrupts the TEMP byte of ours. The loop
+* ends on the first CNT at or past the end tick, never waits for a wrap.
+* With avr-gcc the loop is written in assembly, so LOOP_CYCLES does not
+* depend on the code the compiler picks; the C loop is for the host model.
 *
 */
-unsigned int Counter(void){
+unsigned int CounterTicks(unsigned int ticks){
 	unsigned int cnt;
+	unsigned int end;
 
+	PROFILE_BEGIN(PROFILE_COUNTER);
+	ENTER_CRITICAL(C);
 	cnt = 0;													// Reset counter
-	TIMER_COUNT = 0x00;											// Reset async timer/counter
-	while (STATUS_TIMER_REGISTER > 0);							// Wait until async timer is updated  (Async Status reg. busy flags).
+	end = TIMER_COUNT;											// The RTC keeps running, it is the system time base
+	while (TIMER_COUNT == end);									// Start on a crystal tick edge
+	end += 1 + ticks;
+#if defined(__GNUC__) && defined(__AVR__)
+	{
+		unsigned int now;
+
+		/* Until 32.7KHz (XTAL FREQUENCY) * EXTERNAL TICKS, CNTL is read first for TEMP */
+		__asm__ __volatile__(
+			"1:	adiw %[cnt], 1"				"\n\t"	// 2 clocks
+			"lds  %A[now], %[cntl]"			"\n\t"	// 3 clocks
+			"lds  %B[now], %[cntl]+1"		"\n\t"	// 3 clocks
+			"sub  %A[now], %A[end]"			"\n\t"	// 1 clock
+			"sbc  %B[now], %B[end]"			"\n\t"	// 1 clock
+			"brmi 1b"								// 2 clocks taken
+			: [cnt] "+w" (cnt), [now] "=&r" (now)
+			: [end] "r" (end), [cntl] "i" (_SFR_MEM_ADDR(TIMER_COUNT))
+		);
+		/* = 2 + 3 + 3 + 1 + 1 + 2 = 12 clocks = LOOP_CYCLES */
+	}
+#else
 	do{
-		cnt++;													
-	} while (TIMER_COUNT < EXTERNAL_TICKS);						// Until 32.7KHz (XTAL FREQUENCY) * EXTERNAL TICKS
-	
-	/* caculate number of CPU clocks:
-	cnt++;
-		0000004E  ADIW R24,0x01		Add immediate to word				// 2 clocks
-	
-	while (TIMER_COUNT < EXTERNAL_TICKS);
-		0000004F  LDS R18,0x0148		Load direct from data space		// 3 clocks
-		00000051  LDS R19,0x0149		Load direct from data space		// 3 clocks
-		00000053  CPI R18,0x64		Compare with immediate				// 1 clock
-		00000054  CPC R19,R1		Compare with carry					// 1 clock
-		00000055  BRCS PC-0x07		Branch if carry set					// 1 or 2
-	=================================================================	= 2 + 3 + 3 + 1 + 1 + 2 = 12 clocks
-	*/
+		cnt++;
+	} while ((int16_t)(TIMER_COUNT - end) < 0);
+#endif
+	EXIT_CRITICAL(C);
 	
+	PROFILE_END(PROFILE_COUNTER);
 	return cnt;
 }                                                               
 
@@ -155,34 +527,40 @@ unsigned int Counter(void){
 * prior to it.
 *
 */
-void NeighborSearch(void){
+void NeighborSearch(calib_context_t *ctx){
+	unsigned char next;
 
-	neighborsSearched++;
-	if (neighborsSearched == 4)										// Finish if 3 neighbors searched
+	PROFILE_BEGIN(PROFILE_NEIGHBOR_SEARCH);
+	CALIB_NEIGHBORS(ctx)++;
+	next = CalibTrimAdd(OSCCALR, CALIB_SIGN(ctx));
+	if (CALIB_NEIGHBORS(ctx) == 4 || next == OSCCALR)				// Finish if 3 neighbors searched or at the end of the range
 	{		
-		if (bestCountDiff < (countVal * ACCURACY_DEFAULT))
+		if (ctx->bestCountDiff < (ctx->countVal * ACCURACY_DEFAULT))
 		{
-			success_flag = 1;
-			ccp_write_io((void*)&(OSCCALR), bestOSCCAL);
+			ctx->success_flag = 1;
+			ccp_write_io_inline(OSCCALR, ctx->bestOSCCAL);
 			NOP();
+			ctx->measuredCount = ctx->bestCount;
 		}
 		else
 		{		
-			success_flag = 0;	
-			if (OSCCALR != defaultCalibValueAtmel)
+			ctx->success_flag = 0;	
+			if (OSCCALR != ctx->defaultCalibValueAtmel)
 			{					
-				ccp_write_io((void*)&(OSCCALR), defaultCalibValueAtmel);			// If count is less: increase speed
+				ccp_write_io_inline(OSCCALR, ctx->defaultCalibValueAtmel);		// If count is less: increase speed
 				NOP();
 			}
+			ctx->measuredCount = Counter();					// Default value was not measured during the search
 		}
 		
-		calibration = FINISHED;
+		CALIB_STATE(ctx) = FINISHED;
 	}
 	else
 	{
-		ccp_write_io((void*)&(OSCCALR), OSCCALR + sign);
+		ccp_write_io_inline(OSCCALR, next);
 		NOP();
 	}
+	PROFILE_END(PROFILE_NEIGHBOR_SEARCH);
 }
 
 void _delay_5us(void)
@@ -10,6 +10,7 @@
 #define CALIBRC_H_
 
 #include "Config/clock_config.h"
+#include "device_traits.h"
 
 /*! Calibration methods, Binary search WITH Neighborsearch is default method
  * Uncomment to use ONE of the two following methods instead:
@@ -18,9 +19,17 @@
 //#define CALIBRATION_METHOD_SIMPLE
 #define CALIBRATION_METHOD_TURNING
 
-#define CALIBRATION_FREQUENCY F_CPU
+/*! Error compensation: OSCCALR is never written. A calibration only
+ * measures the clock and publishes its error as calibCorrection, used by
+ * clock_comp and the clock callbacks (PWM) to correct timing in software.
+ * For boards where a step of the CPU clock upsets another subsystem.
+ */
+//#define CALIBRATION_COMPENSATE_ONLY
+
+#define CALIBRATION_FREQUENCY F_CPU		// Only sizes _delay_5us(), the target is read from the fuse at run time
 #define XTAL_FREQUENCY 32768				// Frequency of the external oscillator. A 32kHz crystal is recommended
 #define EXTERNAL_TICKS 100					// ticks on XTAL. Modify to increase/decrease accuracy
+#define XTAL_STARTUP_TIMEOUT_MS 1000		// Max time to wait for the crystal to become stable
 
 #define FALSE 0
 #define TRUE 1
@@ -28,14 +37,17 @@
 #define FINISHED 1
 
 /*
-Depends on device type, see the datasheet for suitable selection
+Depends on device type, see device_traits.h
 */
-#define DEFAULT_OSCCAL_MASK				0xC0
-#define OSCCALR							CLKCTRL.OSC20MCALIBA
+#if !DEVICE_HAS_RTC || !DEVICE_HAS_XOSC32K
+#error The calibration needs the RTC clocked from a 32.768 kHz crystal (XOSC32K)
+#endif
+#define DEFAULT_OSCCAL_MASK				(0xFF & ~DEVICE_TRIM_MASK)
+#define OSCCALR							DEVICE_TRIM_REGISTER
 #define STATUS_TIMER_REGISTER			RTC.STATUS
 #define TIMER_COUNT                     RTC.CNT
-#define OSCCAL_RESOLUTION                  6
-#define LOOP_CYCLES                       12
+#define OSCCAL_RESOLUTION				DEVICE_TRIM_BITS
+#define LOOP_CYCLES						DEVICE_LOOP_CYCLES
 
 #define ACCURACY_DEFAULT		2/100			// 2%
 #define COUNT_RETRY				20
@@ -43,12 +55,87 @@ Depends on device type, see the datasheet for suitable selection
 #define DEFAULT_OSCCAL      ((1 << (OSCCAL_RESOLUTION - 1)) | DEFAULT_OSCCAL_MASK)
 
 #define NOP() _delay_5us()				// Time for the oscillation to stabilize every time it changes
+void _delay_5us(void);
 
 // Absolute value macro.
 #define ABS(var) (((var) < 0) ? -(var) : (var));
 
-void InitCalibRc(void);
+/*! Supply bands with their own trim code, see BOD_vlm_band().
+ * Band 0 is close to brown-out: no search there, the factory value is used.
+ */
+#define CALIB_VDD_BANDS					4
+#define CALIB_BAND_UNKNOWN				0xFF
+
+//! 1.0 in the Q16 format of calibCorrection
+#define CALIB_Q16_ONE					65536UL
+
+/*! Keep the hottest calibration state (state, neighbor count, step sign) in
+ * GPIOR0-2 for single cycle in/out access instead of lds/sts.
+ * Only one context can then be calibrated at a time. GPIOR3 stays free.
+ */
+//#define CALIBRATION_STATE_IN_GPIOR
+
+/*! \brief Calibration state
+ *
+ * One context per calibration target. The engine keeps no other state,
+ * so contexts can be calibrated one after another or from an ISR.
+ */
+typedef struct {
+	unsigned int countVal;						// The desired counter value
+	unsigned long oscFrequency;					// OSC20M target, the CPU target times the prescaler
+	unsigned char prescaler;					// CLK_PER prescaler countVal and the counts are for
+	unsigned int bestCountDiff;					// The lowest difference between desired and measured counter value
+	unsigned int bestCount;						// The counter value measured with bestOSCCAL
+	unsigned int measuredCount;					// Counter value of the OSCCALR left in place, 0 if unknown
+	unsigned char defaultCalibValueAtmel;		// OSCCALR when the context was initialized
+	unsigned char bestOSCCAL;					// The OSCCALR value corresponding to the bestCountDiff
+	unsigned char calStep;						// The binary search step size
+	signed char success_flag;					// Result of the last calibration
+	unsigned char vddBand;						// Supply band OSCCALR is set for, CALIB_BAND_UNKNOWN if not known
+	unsigned char bandValid;					// Bit n set when bandOSCCAL[n] holds a calibrated code
+	unsigned char bandOSCCAL[CALIB_VDD_BANDS];	// Calibrated OSCCALR per supply band
+	unsigned int bandCount[CALIB_VDD_BANDS];	// Counter value measured with bandOSCCAL[n]
+#ifndef CALIBRATION_STATE_IN_GPIOR
+	unsigned char calibration;					// Calibration status, RUNNING or FINISHED
+	unsigned char neighborsSearched;			// Holds the number of neighbors searched
+	signed char sign;							// Stores the direction of the binary step (-1 or 1)
+#endif
+} calib_context_t;
+
+#ifdef CALIBRATION_STATE_IN_GPIOR
+#define CALIB_STATE(ctx)				GPIOR0
+#define CALIB_NEIGHBORS(ctx)			GPIOR1
+#define CALIB_SIGN(ctx)					(*(volatile signed char *)&GPIOR2)
+#else
+#define CALIB_STATE(ctx)				((ctx)->calibration)
+#define CALIB_NEIGHBORS(ctx)			((ctx)->neighborsSearched)
+#define CALIB_SIGN(ctx)					((ctx)->sign)
+#endif
+
+//! Called after a calibration or a clock switch with the CPU clock in Hz
+typedef void (*calib_clock_cb_t)(unsigned long frequency);
+
+//! Drivers that can be registered with CalibAddClockCallback()
+#define CALIB_CLOCK_CALLBACKS			4
+
+extern calib_context_t calibDefault;
+extern volatile unsigned long calibCorrection;
+extern unsigned int xtalStartupMs;
+
+signed char InitCalibRc(void);
 signed char CalibInternalRc(void);
 
+void InitCalibContext(calib_context_t *ctx, unsigned long frequency);
+signed char CalibrateContext(calib_context_t *ctx);
+unsigned long CalibMeasuredFrequency(calib_context_t *ctx);
+signed char CalibAddClockCallback(calib_clock_cb_t cb);
+void CalibNotifyClock(unsigned long frequency);
+signed int CalibVerify(calib_context_t *ctx, unsigned int ticks);
+signed char CalibSetVddBand(calib_context_t *ctx, unsigned char band);
+void CalibFollowPrescaler(calib_context_t *ctx);
+signed char CalibSwitchOscillator(calib_context_t *ctx, unsigned long oscFrequency);
+signed char CalibMeasureError(calib_context_t *ctx);
+unsigned long CalibCorrect(unsigned long value);
+
 
 #endif /* CALIBRC_H_ */
\ No newline at end of file
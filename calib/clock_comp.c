@@ -0,0 +1,66 @@
+/*
+ * clock_comp.c
+ */
+
+#include "clock_comp.h"
+#include "calibRC.h"
+#include <clkctrl.h>
+#include <util/delay_basic.h>
+
+/*! \brief The CPU clock calibCorrection is relative to, in kHz
+*
+* The target of calibDefault (FREQSEL fuse, see InitCalibRc()) at the
+* running prescaler, F_CPU before InitCalibRc().
+*/
+static uint32_t clock_comp_nominal_khz(void)
+{
+	uint32_t osc = calibDefault.oscFrequency;
+
+	if (osc == 0) {
+		return F_CPU / 1000UL;
+	}
+	return osc / CLKCTRL_prescaler() / 1000UL;
+}
+
+/*! \brief Busy wait \a cycles CPU cycles, in steps of 4
+*/
+static void clock_comp_delay_cycles(uint32_t cycles)
+{
+	uint32_t loops = cycles >> 2;
+
+	while (loops > 0xFFFF) {
+		_delay_loop_2(0); // 65536 loops
+		loops -= 0x10000;
+	}
+	if (loops) {
+		_delay_loop_2(loops);
+	}
+}
+
+/*! \brief _delay_us() corrected for the measured clock
+*/
+void clock_comp_delay_us(uint16_t us)
+{
+	clock_comp_delay_cycles(CalibCorrect(((uint32_t)us * clock_comp_nominal_khz()) / 1000));
+}
+
+/*! \brief _delay_ms() corrected for the measured clock
+*/
+void clock_comp_delay_ms(uint16_t ms)
+{
+	clock_comp_delay_cycles(CalibCorrect((uint32_t)ms * clock_comp_nominal_khz()));
+}
+
+/*! \brief USART BAUD register value at the measured clock
+*
+* Normal speed mode (16 samples per bit), as the START USART_BAUD_RATE()
+* macro computes it, from the corrected clock instead of F_CPU.
+*
+* \param baud Bit rate in bit/s
+*/
+uint16_t clock_comp_usart_baud(uint32_t baud)
+{
+	uint32_t clk = CalibCorrect(clock_comp_nominal_khz() * 1000UL);
+
+	return (clk * 4 + baud / 2) / baud; // 64 * clk / (16 * baud), rounded
+}
@@ -0,0 +1,30 @@
+/*
+ * clock_comp.h
+ */
+
+
+#ifndef CLOCK_COMP_H_
+#define CLOCK_COMP_H_
+
+#include <compiler.h>
+
+/*! Timing corrected by calibCorrection instead of a trimmed oscillator.
+ *
+ * Replacements for _delay_us()/_delay_ms() and the START USART baud
+ * macro. Instead of F_CPU they take the calibration target as the nominal
+ * clock (FREQSEL fuse and MCLKCTRLB prescaler, read at run time), and
+ * scale it by the clock error of the last measurement (see
+ * CALIBRATION_COMPENSATE_ONLY).
+ * They also work with a trimmed oscillator, where the factor stays close
+ * to 1. PWM_0 and PWM_TCD_0 get the measured clock through the clock
+ * callbacks instead.
+ *
+ * The delays are busy loops of 4 cycles, with ~1000 cycles to scale the
+ * argument (two 32-bit divisions): use _delay_us() for short delays.
+ */
+
+void clock_comp_delay_us(uint16_t us);
+void clock_comp_delay_ms(uint16_t ms);
+uint16_t clock_comp_usart_baud(uint32_t baud);
+
+#endif /* CLOCK_COMP_H_ */
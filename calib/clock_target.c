@@ -0,0 +1,141 @@
+/*
+ * clock_target.c
+ */
+
+#include "clock_target.h"
+#include "calibRC.h"
+#include "profile.h"
+#include <ccp.h>
+#include <clkctrl.h>
+
+clock_target_t clock_targets[CLOCK_TARGETS];
+
+static uint8_t clock_target_count;
+static int8_t  clock_target_selected = -1;
+//! OSCCALR of calibDefault, put back by clock_target_release()
+static uint8_t clock_target_default;
+
+/*! \brief The CPU clock with the code of calibDefault
+*/
+static uint32_t clock_target_default_hz(void)
+{
+	if (calibDefault.measuredCount) {
+		return CalibMeasuredFrequency(&calibDefault);
+	}
+	return calibDefault.oscFrequency / CLKCTRL_prescaler();
+}
+
+/*! \brief Add a CPU clock to switch to
+*
+* \param frequency CPU clock in Hz at the current prescaler
+*
+* \return Index for clock_target_select(), -1 if CLOCK_TARGETS are in use
+*/
+int8_t clock_target_add(uint32_t frequency)
+{
+	clock_target_t *t;
+
+	if (clock_target_count >= CLOCK_TARGETS) {
+		return -1;
+	}
+	t            = &clock_targets[clock_target_count];
+	t->frequency = frequency;
+	t->osc_hz    = 0;
+	t->result    = -1;
+	return clock_target_count++;
+}
+
+/*! \brief Search the trim code of every target
+*
+* One full calibration per target (~20 ms each), needs InitCalibRc() done.
+* The selected target, or the code in place if none is selected, is
+* restored afterwards and the drivers are notified of it.
+*
+* \return Number of targets calibrated within ACCURACY_DEFAULT, always 0
+*         with CALIBRATION_COMPENSATE_ONLY, which never writes OSCCALR
+*/
+uint8_t clock_target_calibrate(void)
+{
+	uint8_t ok = 0;
+
+#ifndef CALIBRATION_COMPENSATE_ONLY
+	calib_context_t ctx;
+	uint8_t         osccal = OSCCALR;
+
+	for (uint8_t i = 0; i < clock_target_count; i++) {
+		clock_target_t *t = &clock_targets[i];
+
+		InitCalibContext(&ctx, t->frequency);
+		t->result = CalibrateContext(&ctx);
+		t->osc_hz = 0;
+		if (t->result == 1) {
+			t->osccal = OSCCALR;
+			t->osc_hz = CalibMeasuredFrequency(&ctx) * ctx.prescaler;
+			ok++;
+		}
+		ccp_write_io_inline(OSCCALR, osccal);
+		NOP();
+	}
+
+	if (clock_target_selected < 0 || clock_target_select(clock_target_selected) < 0) {
+		clock_target_release(); /* Also undoes the notifications of the searches */
+	}
+#endif
+	return ok;
+}
+
+/*! \brief Switch the CPU to a calibrated target
+*
+* The switch itself is the protected OSCCALR write and the settle delay;
+* the drivers are notified afterwards, outside of it.
+*
+* \return 0, or -1 if \a target was not calibrated
+*/
+int8_t clock_target_select(uint8_t target)
+{
+	clock_target_t *t;
+
+	if (target >= clock_target_count || clock_targets[target].osc_hz == 0) {
+		return -1;
+	}
+	t = &clock_targets[target];
+
+	if (clock_target_selected < 0) {
+		clock_target_default = OSCCALR;
+	}
+
+	PROFILE_BEGIN(PROFILE_CLOCK_SWITCH);
+	ccp_write_io_inline(OSCCALR, t->osccal);
+	NOP();
+	PROFILE_END(PROFILE_CLOCK_SWITCH);
+	clock_target_selected = target;
+
+	PROFILE_BEGIN(PROFILE_CLOCK_NOTIFY);
+	CalibNotifyClock(t->osc_hz / CLKCTRL_prescaler());
+	PROFILE_END(PROFILE_CLOCK_NOTIFY);
+	return 0;
+}
+
+/*! \brief Go back to the code of calibDefault
+*
+* Puts back the OSCCALR found when the first target was selected, so
+* recal_policy takes over again, and notifies the drivers.
+*/
+void clock_target_release(void)
+{
+	if (clock_target_selected >= 0) {
+		ccp_write_io_inline(OSCCALR, clock_target_default);
+		NOP();
+		clock_target_selected = -1;
+	}
+	CalibNotifyClock(clock_target_default_hz());
+}
+
+/*! \brief The target selected last
+*
+* \return Its index, -1 if none is selected (calibDefault is in use)
+*/
+int8_t clock_target_current(void)
+{
+	return clock_target_selected;
+}
@@ -0,0 +1,44 @@
+/*
+ * clock_target.h
+ */
+
+
+#ifndef CLOCK_TARGET_H_
+#define CLOCK_TARGET_H_
+
+#include <compiler.h>
+
+/*! Several CPU clocks calibrated once, switched at run time.
+ *
+ * Each target (e.g. a UART-exact clock and the fastest clock) is searched
+ * once by clock_target_calibrate() and its best OSCCALR code stored. A
+ * switch is then one protected write plus the settle time of the
+ * oscillator; the drivers registered with CalibAddClockCallback() are
+ * notified after it. With PROFILE_ENABLE the switch is profiled as
+ * PROFILE_CLOCK_SWITCH and the notification as PROFILE_CLOCK_NOTIFY.
+ *
+ * All targets share the prescaler running when they are calibrated.
+ * recal_policy keeps calibDefault and pauses while a target is selected:
+ * call clock_target_calibrate() again when conditions change, or
+ * clock_target_release() to hand the oscillator back.
+ */
+
+//! Number of targets that can be added
+#define CLOCK_TARGETS 4
+
+typedef struct {
+	uint32_t frequency; // Requested CPU clock in Hz
+	uint32_t osc_hz;    // OSC20M measured with osccal, 0 if not calibrated
+	uint8_t  osccal;    // Best OSCCALR code found
+	int8_t   result;    // CalibrateContext() result of the last calibration
+} clock_target_t;
+
+extern clock_target_t clock_targets[CLOCK_TARGETS];
+
+int8_t clock_target_add(uint32_t frequency);
+uint8_t clock_target_calibrate(void);
+int8_t clock_target_select(uint8_t target);
+void clock_target_release(void);
+int8_t clock_target_current(void);
+
+#endif /* CLOCK_TARGET_H_ */
@@ -0,0 +1,92 @@
+/*
+ * device_traits.h
+ */
+
+
+#ifndef DEVICE_TRAITS_H_
+#define DEVICE_TRAITS_H_
+
+/*! Compile-time description of the supported devices.
+ *
+ * The device is taken from the -mmcu define of the compiler. Everything
+ * is a constant, so the calibration engine and the drivers specialize on
+ * it with no runtime cost.
+ *
+ * DEVICE_SERIES        One of the DEVICE_SERIES_* below
+ * DEVICE_TRIM_REGISTER Oscillator trim register written by the calibration
+ * DEVICE_TRIM_BITS     Width of the trim field, from bit 0
+ * DEVICE_TRIM_STEP_PERMILLE Typical frequency change of one trim code,
+ *                      only used to size the coarse steps of the search
+ * DEVICE_HAS_RTC       RTC (soft timers, scheduler)
+ * DEVICE_HAS_XOSC32K   32.768 kHz crystal oscillator, required by the
+ *                      calibration; none on the tinyAVR 0-series, and the
+ *                      8-pin 1-series parts have no TOSC pins
+ * DEVICE_HAS_TCB       TCB0 (profiler, latency harness)
+ * DEVICE_HAS_TCD       TCD0 (pwm_tcd)
+ * DEVICE_LOOP_CYCLES   Cycles of one Counter() loop, see calibRC.c
+ *
+ * All these parts have the AVRxt core: ADIW 2, LDS 3, SUB/SBC 1, BRMI 2
+ * cycles, so the Counter() loop is 12 cycles everywhere.
+ */
+
+#define DEVICE_SERIES_TINY0 0
+#define DEVICE_SERIES_TINY1 1
+#define DEVICE_SERIES_TINY2 2
+#define DEVICE_SERIES_MEGA0 3
+
+#if defined(__AVR_ATtiny202__) || defined(__AVR_ATtiny204__) || defined(__AVR_ATtiny402__)                            \
+    || defined(__AVR_ATtiny404__) || defined(__AVR_ATtiny406__) || defined(__AVR_ATtiny804__)                          \
+    || defined(__AVR_ATtiny806__) || defined(__AVR_ATtiny807__) || defined(__AVR_ATtiny1604__)                         \
+    || defined(__AVR_ATtiny1606__) || defined(__AVR_ATtiny1607__)
+#define DEVICE_SERIES DEVICE_SERIES_TINY0
+#define DEVICE_TRIM_BITS 6
+#define DEVICE_TRIM_STEP_PERMILLE 10
+#define DEVICE_HAS_TCD 0
+
+#elif defined(__AVR_ATtiny212__) || defined(__AVR_ATtiny214__) || defined(__AVR_ATtiny412__)                          \
+    || defined(__AVR_ATtiny414__) || defined(__AVR_ATtiny416__) || defined(__AVR_ATtiny417__)                          \
+    || defined(__AVR_ATtiny814__) || defined(__AVR_ATtiny816__) || defined(__AVR_ATtiny817__)                          \
+    || defined(__AVR_ATtiny1614__) || defined(__AVR_ATtiny1616__) || defined(__AVR_ATtiny1617__)                       \
+    || defined(__AVR_ATtiny3216__) || defined(__AVR_ATtiny3217__)
+#define DEVICE_SERIES DEVICE_SERIES_TINY1
+#define DEVICE_TRIM_BITS 6
+#define DEVICE_TRIM_STEP_PERMILLE 10
+#define DEVICE_HAS_TCD 1
+
+#elif defined(__AVR_ATtiny424__) || defined(__AVR_ATtiny426__) || defined(__AVR_ATtiny427__)                          \
+    || defined(__AVR_ATtiny824__) || defined(__AVR_ATtiny826__) || defined(__AVR_ATtiny827__)                          \
+    || defined(__AVR_ATtiny1624__) || defined(__AVR_ATtiny1626__) || defined(__AVR_ATtiny1627__)                       \
+    || defined(__AVR_ATtiny3224__) || defined(__AVR_ATtiny3226__) || defined(__AVR_ATtiny3227__)
+#define DEVICE_SERIES DEVICE_SERIES_TINY2
+#define DEVICE_TRIM_BITS 7
+#define DEVICE_TRIM_STEP_PERMILLE 8
+#define DEVICE_HAS_TCD 0
+
+#elif defined(__AVR_ATmega808__) || defined(__AVR_ATmega809__) || defined(__AVR_ATmega1608__)                         \
+    || defined(__AVR_ATmega1609__) || defined(__AVR_ATmega3208__) || defined(__AVR_ATmega3209__)                       \
+    || defined(__AVR_ATmega4808__) || defined(__AVR_ATmega4809__)
+#define DEVICE_SERIES DEVICE_SERIES_MEGA0
+#define DEVICE_TRIM_BITS 7
+#define DEVICE_TRIM_STEP_PERMILLE 8
+#define DEVICE_HAS_TCD 0
+
+#else
+#error Unsupported device: tinyAVR 0/1/2-series or megaAVR 0-series only
+#endif
+
+/* Common to every supported series */
+#define DEVICE_TRIM_REGISTER CLKCTRL.OSC20MCALIBA
+#define DEVICE_HAS_RTC 1
+/* The tinyAVR 0-series only has OSCULP32K and an external clock input */
+#if DEVICE_SERIES == DEVICE_SERIES_TINY0 || defined(__AVR_ATtiny212__) || defined(__AVR_ATtiny412__)
+#define DEVICE_HAS_XOSC32K 0
+#else
+#define DEVICE_HAS_XOSC32K 1
+#endif
+#define DEVICE_HAS_TCB 1
+#define DEVICE_LOOP_CYCLES 12
+
+//! The trim field of DEVICE_TRIM_REGISTER, the bits above it are kept
+#define DEVICE_TRIM_MASK ((1 << DEVICE_TRIM_BITS) - 1)
+
+#endif /* DEVICE_TRAITS_H_ */
@@ -35,3 +35,100 @@
 
 #include <driver_init.h>
 #include <compiler.h>
+#include <pwm_basic.h>
+#include <rtc.h>
+#include <bod.h>
+
+ISR(BOD_VLM_vect)
+{
+	BOD.INTFLAGS = BOD_VLMIF_bm;
+	BOD_vlm_cb();
+}
+
+/*
+ * RTC overflow and compare share this vector. The overflow is counted
+ * first so a compare callback already sees the new extended time.
+ */
+ISR(RTC_CNT_vect)
+{
+	uint8_t flags = RTC.INTFLAGS & RTC.INTCTRL;
+
+	if (flags & RTC_OVF_bm) {
+		RTC.INTFLAGS = RTC_OVF_bm;
+		RTC_0_ovf_count++;
+	}
+	if (flags & RTC_CMP_bm) {
+		RTC.INTFLAGS = RTC_CMP_bm;
+		RTC_0_compare_isr();
+	}
+}
+
+ISR(RTC_PIT_vect)
+{
+	RTC.PITINTFLAGS = RTC_PI_bm;
+	RTC_0_pit_cb();
+}
+
+#if PWM_0_INTERRUPT_CB_RATE == 1
+
+/*
+ * TCA0 overflow, callback every period.
+ * Latency to the callback: ~6 cycles interrupt response, ~25 cycles
+ * prologue (call-clobbered registers), 3 cycles flag clear, 3 cycles icall.
+ */
+ISR(TCA0_OVF_vect)
+{
+	TCA0.SINGLE.INTFLAGS = TCA_SINGLE_OVF_bm;
+	PWM_0_cb();
+}
+
+#else
+
+/*
+ * Last overflow of a PWM_0_INTERRUPT_CB_RATE group. Reached by a jump from
+ * the vector with the stack exactly as the interrupt left it, so it is a
+ * complete handler ending in reti. The __vector prefix only stops GCC from
+ * flagging the signal attribute on a non-vector name.
+ */
+void __vector_PWM_0_ovf_cb(void) __attribute__((signal, used));
+void __vector_PWM_0_ovf_cb(void)
+{
+	PWM_0_cb();
+}
+
+/*
+ * TCA0 overflow with rate divider. The down-counter lives in GPIOR3, so a
+ * skipped period only saves r24 and SREG: 20 cycles from vector to reti,
+ * ~26 cycles worst case including the interrupt response. The callback is
+ * reached ~20 cycles later than with the direct handler.
+ */
+ISR(TCA0_OVF_vect, ISR_NAKED)
+{
+	__asm__ __volatile__("push r24"                                  "\n\t"
+	                     "in   r24, __SREG__"                        "\n\t"
+	                     "push r24"                                  "\n\t"
+	                     "ldi  r24, %[ovf]"                          "\n\t"
+	                     "sts  %[flags], r24"                        "\n\t"
+	                     "in   r24, %[div]"                          "\n\t"
+	                     "dec  r24"                                  "\n\t"
+	                     "out  %[div], r24"                          "\n\t"
+	                     "brne 1f"                                   "\n\t"
+	                     "ldi  r24, %[rate]"                         "\n\t"
+	                     "out  %[div], r24"                          "\n\t"
+	                     "pop  r24"                                  "\n\t"
+	                     "out  __SREG__, r24"                        "\n\t"
+	                     "pop  r24"                                  "\n\t"
+	                     "%~jmp __vector_PWM_0_ovf_cb"               "\n\t"
+	                     "1:"                                        "\n\t"
+	                     "pop  r24"                                  "\n\t"
+	                     "out  __SREG__, r24"                        "\n\t"
+	                     "pop  r24"                                  "\n\t"
+	                     "reti"                                      "\n\t"
+	                     :
+	                     : [ovf] "M"(TCA_SINGLE_OVF_bm),
+	                       [flags] "n"(_SFR_MEM_ADDR(TCA0.SINGLE.INTFLAGS)),
+	                       [div] "I"(_SFR_IO_ADDR(GPIOR3)),
+	                       [rate] "M"(PWM_0_INTERRUPT_CB_RATE));
+}
+
+#endif /* PWM_0_INTERRUPT_CB_RATE */
@@ -0,0 +1,33 @@
+/*
+ * cpuint_latency_example.h
+ */
+
+
+#ifndef CPUINT_LATENCY_EXAMPLE_H_
+#define CPUINT_LATENCY_EXAMPLE_H_
+
+#include <compiler.h>
+
+/*! Set to 1 to build the harness. It owns the TCB0 vector and TCB0 itself,
+ * so it cannot be built with PROFILE_ENABLE.
+ */
+#define CPUINT_LATENCY_EXAMPLE 0
+
+//! Configurations measured by cpuint_latency_test()
+enum cpuint_latency_config {
+	CPUINT_LAT_DEFAULT,     // Everything level 0, static priority
+	CPUINT_LAT_LEVEL1,      // TCB0 level 1
+	CPUINT_LAT_ROUND_ROBIN, // Everything level 0, round-robin
+	CPUINT_LAT_CONFIG_COUNT
+};
+
+typedef struct {
+	uint16_t min; // Cycles from the TCB0 wrap to the first handler statement
+	uint16_t max;
+} cpuint_latency_t;
+
+extern cpuint_latency_t cpuint_latency[CPUINT_LAT_CONFIG_COUNT];
+
+uint8_t cpuint_latency_test(void);
+
+#endif /* CPUINT_LATENCY_EXAMPLE_H_ */
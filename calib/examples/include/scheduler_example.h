@@ -0,0 +1,16 @@
+/*
+ * scheduler_example.h
+ */
+
+
+#ifndef SCHEDULER_EXAMPLE_H_
+#define SCHEDULER_EXAMPLE_H_
+
+#include <compiler.h>
+#include "scheduler.h"
+
+extern scheduler_stats_t scheduler_bench_stats[2];
+
+uint8_t scheduler_benchmark(void);
+
+#endif /* SCHEDULER_EXAMPLE_H_ */
@@ -0,0 +1,13 @@
+/*
+ * soft_timer_example.h
+ */
+
+
+#ifndef SOFT_TIMER_EXAMPLE_H_
+#define SOFT_TIMER_EXAMPLE_H_
+
+#include <compiler.h>
+
+uint8_t soft_timer_benchmark(void);
+
+#endif /* SOFT_TIMER_EXAMPLE_H_ */
@@ -0,0 +1,99 @@
+/*
+ * cpuint_latency_example.c
+ */
+
+#include <atmel_start.h>
+#include <cpuint_latency_example.h>
+#include "profile.h"
+
+#if CPUINT_LATENCY_EXAMPLE
+
+#if PROFILE_ENABLE
+#error The CPUINT latency harness uses TCB0, disable PROFILE_ENABLE
+#endif
+
+//! TCB0 period, prime against the 1000 count PWM_0 period so every phase is seen
+#define LAT_PERIOD 997
+//! Samples per configuration
+#define LAT_SAMPLES 4000
+//! Cycles spent in the competing level 0 handler
+#define LAT_LOAD_CYCLES 200
+
+cpuint_latency_t cpuint_latency[CPUINT_LAT_CONFIG_COUNT];
+
+static volatile uint16_t lat_samples;
+static uint8_t           lat_config;
+
+/*
+ * TCB0 wraps to 0 and raises CAPT at the same time, so CNT read first in
+ * the handler is the latency: interrupt response, vector jump, prologue,
+ * plus whatever held it off.
+ */
+ISR(TCB0_INT_vect)
+{
+	uint16_t cnt = TCB0.CNT;
+
+	TCB0.INTFLAGS = TCB_CAPT_bm;
+	if (cnt < cpuint_latency[lat_config].min) {
+		cpuint_latency[lat_config].min = cnt;
+	}
+	if (cnt > cpuint_latency[lat_config].max) {
+		cpuint_latency[lat_config].max = cnt;
+	}
+	lat_samples++;
+}
+
+/*! Competing level 0 load on the PWM_0 overflow, vector below TCB0 */
+static void lat_load_cb(void)
+{
+	__builtin_avr_delay_cycles(LAT_LOAD_CYCLES);
+}
+
+/*! \brief Worst-case interrupt entry latency per CPUINT configuration
+*
+* TCB0 interrupts every LAT_PERIOD cycles while the PWM_0 overflow runs a
+* LAT_LOAD_CYCLES handler every period. For each configuration the min
+* and max entry latency are stored in cpuint_latency[], in CLK_PER cycles.
+* Expected at 5 MHz: ~35 cycles min everywhere. The max is ~35 + the
+* load handler at level 0 (TCB0 waits for it to end), ~35 + the longest
+* cli section at level 1. Round-robin does not shorten a single wait, it
+* bounds how many other level 0 handlers can run first.
+*
+* \return 1 when all configurations were measured
+*/
+uint8_t cpuint_latency_test(void)
+{
+	PWM_0_register_callback(lat_load_cb);
+
+	for (lat_config = 0; lat_config < CPUINT_LAT_CONFIG_COUNT; lat_config++) {
+		CPUINT_set_level1_vector(lat_config == CPUINT_LAT_LEVEL1 ? TCB0_INT_vect_num : 0);
+		CPUINT_set_round_robin(lat_config == CPUINT_LAT_ROUND_ROBIN);
+		CPUINT_set_level0_priority(0);
+
+		cpuint_latency[lat_config].min = 0xFFFF;
+		cpuint_latency[lat_config].max = 0;
+		lat_samples                    = 0;
+
+		TCB0.CCMP     = LAT_PERIOD - 1;
+		TCB0.CNT      = 0;
+		TCB0.CTRLB    = TCB_CNTMODE_INT_gc;
+		TCB0.INTFLAGS = TCB_CAPT_bm;
+		TCB0.INTCTRL  = TCB_CAPT_bm;
+		TCB0.CTRLA    = TCB_CLKSEL_CLKDIV1_gc | 1 << TCB_ENABLE_bp;
+
+		while (lat_samples < LAT_SAMPLES)
+			;
+
+		TCB0.CTRLA   = 0;
+		TCB0.INTCTRL = 0;
+	}
+
+	PWM_0_register_callback(NULL);
+	CPUINT_set_level1_vector(CPUINT_LVL1_VECTOR);
+	CPUINT_set_round_robin(CPUINT_ROUND_ROBIN);
+	CPUINT_set_level0_priority(CPUINT_LVL0_PRIORITY);
+
+	return 1;
+}
+
+#endif /* CPUINT_LATENCY_EXAMPLE */
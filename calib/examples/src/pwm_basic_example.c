@@ -33,6 +33,14 @@
 volatile uint16_t         PWM_0_isr_executed_counter = 0;
 volatile PWM_0_register_t PWM_0_duty;
 
+void PWM_0_pwm_handler_cb(void)
+{
+	PWM_0_duty++;
+	// Output duty cycle on PWM CH0
+	PWM_0_load_duty_cycle_ch0(PWM_0_duty);
+	PWM_0_isr_executed_counter++;
+}
+
 uint8_t PWM_0_test_pwm_basic(void)
 {
 
@@ -45,5 +53,16 @@ uint8_t PWM_0_test_pwm_basic(void)
 	// Set counter register value
 	PWM_0_load_counter(0);
 
+	// Test IRQ mode
+	ENABLE_INTERRUPTS();
+
+	PWM_0_register_callback(PWM_0_pwm_handler_cb);
+
+	// Wait for ISR to be executed 65000 times
+	while (PWM_0_isr_executed_counter < 65000)
+		;
+
+	PWM_0_register_callback(NULL);
+
 	return 1;
 }
@@ -0,0 +1,92 @@
+/*
+ * scheduler_example.c
+ */
+
+#include <atmel_start.h>
+#include <scheduler_example.h>
+#include "soft_timer.h"
+
+//! Length of the standby pass
+#define BENCH_RUN_MS 2000
+//! PWM_0 burst every BENCH_BURST_PERIOD_MS, BENCH_BURST_MS long
+#define BENCH_BURST_PERIOD_MS 100
+#define BENCH_BURST_MS 10
+//! PIT wake-ups of the power-down pass, one per second
+#define BENCH_PIT_WAKEUPS 4
+
+/*! scheduler_stats after each pass, read them with the debugger after
+ * scheduler_benchmark() returned: [0] PWM_0 bursts and timers (IDLE and
+ * STANDBY), [1] no timer, PIT wake-ups (POWERDOWN).
+ */
+scheduler_stats_t scheduler_bench_stats[2];
+
+static soft_timer_t     bench_burst, bench_burst_end, bench_end;
+static volatile uint8_t bench_done;
+static volatile uint8_t bench_pit_count;
+
+static void bench_burst_end_cb(soft_timer_t *timer)
+{
+	(void)timer;
+	PWM_0_disable();
+}
+
+static void bench_burst_cb(soft_timer_t *timer)
+{
+	(void)timer;
+	PWM_0_enable();
+	soft_timer_start(&bench_burst_end, SOFT_TIMER_MS(BENCH_BURST_MS), 0, bench_burst_end_cb);
+}
+
+static void bench_end_cb(soft_timer_t *timer)
+{
+	(void)timer;
+	bench_done = 1;
+}
+
+static void bench_pit_cb(void)
+{
+	bench_pit_count++;
+}
+
+/*! \brief Time spent in each sleep mode with PWM_0 mostly stopped
+*
+* A running TCA0 keeps the scheduler in IDLE, so with PWM_0 always on the
+* deeper modes are never used. The first pass runs PWM_0 in bursts of
+* BENCH_BURST_MS every BENCH_BURST_PERIOD_MS: expect ~10% of the ticks in
+* IDLE and the rest in STANDBY. The second pass runs no timer, so the
+* scheduler powers down and only the PIT wakes it; the RTC counter stops
+* there, so its POWERDOWN time is filled in from the PIT period.
+* Needs interrupts enabled, the RTC running and soft_timer_init() done,
+* with no other soft timer running: those would wake the scheduler too.
+* Takes ~6 s. PWM_0 and the benchmark timers are left stopped.
+*
+* \return 1 when both passes reached their deeper mode
+*/
+uint8_t scheduler_benchmark(void)
+{
+	scheduler_init();
+	PWM_0_disable();
+	bench_done = 0;
+	soft_timer_start(&bench_burst, 0, SOFT_TIMER_MS(BENCH_BURST_PERIOD_MS), bench_burst_cb);
+	soft_timer_start(&bench_end, SOFT_TIMER_MS(BENCH_RUN_MS), 0, bench_end_cb);
+	while (!bench_done) {
+		scheduler_step();
+	}
+	soft_timer_cancel(&bench_burst);
+	soft_timer_cancel(&bench_burst_end);
+	PWM_0_disable();
+	scheduler_bench_stats[0] = scheduler_stats;
+
+	scheduler_init();
+	bench_pit_count = 0;
+	RTC_0_pit_start(RTC_PERIOD_CYC32768_gc, bench_pit_cb);
+	while (bench_pit_count < BENCH_PIT_WAKEUPS) {
+		scheduler_step();
+	}
+	RTC_0_pit_stop();
+	scheduler_stats.ticks[SCHEDULER_POWERDOWN] = (rtc_time_t)scheduler_stats.count[SCHEDULER_POWERDOWN] * 32768;
+	scheduler_bench_stats[1] = scheduler_stats;
+
+	return scheduler_bench_stats[0].ticks[SCHEDULER_STANDBY] > scheduler_bench_stats[0].ticks[SCHEDULER_IDLE]
+	       && scheduler_bench_stats[1].count[SCHEDULER_POWERDOWN] >= BENCH_PIT_WAKEUPS;
+}
@@ -0,0 +1,76 @@
+/*
+ * soft_timer_example.c
+ */
+
+#include <atmel_start.h>
+#include <soft_timer_example.h>
+#include "soft_timer.h"
+#include "profile.h"
+
+#define BENCH_MAX_TIMERS 64
+
+static soft_timer_t       bench_timers[BENCH_MAX_TIMERS];
+static volatile uint8_t   bench_fired;
+static const uint8_t      bench_counts[] = {1, 8, 32, 64};
+
+/*! Average cycles of start, cancel, process (without the callbacks) and rearm
+ * for each entry of bench_counts[],
+ * read them with the debugger after soft_timer_benchmark() returned.
+ */
+uint16_t soft_timer_bench_cycles[ARRAY_SIZE(bench_counts)][4];
+
+static void bench_cb(soft_timer_t *timer)
+{
+	(void)timer;
+	bench_fired++;
+}
+
+static uint16_t bench_avg(uint8_t region)
+{
+#if PROFILE_ENABLE
+	return profile_stats[region].count ? profile_stats[region].total / profile_stats[region].count : 0;
+#else
+	(void)region;
+	return 0;
+#endif
+}
+
+/*! \brief Scheduling overhead against the number of running timers
+*
+* For each count, starts the timers with deadlines spread over two turns of
+* the wheel, cancels every second one and lets the others expire, so
+* process is measured with a single timer too.
+* Needs PROFILE_ENABLE, interrupts enabled and the RTC running.
+*
+* \return 1 when all the remaining timers fired
+*/
+uint8_t soft_timer_benchmark(void)
+{
+	uint8_t ok = 1;
+
+	for (uint8_t c = 0; c < ARRAY_SIZE(bench_counts); c++) {
+		uint8_t n = bench_counts[c];
+
+		soft_timer_init();
+		PROFILE_INIT();
+		bench_fired = 0;
+
+		for (uint8_t i = 0; i < n; i++) {
+			/* 2 to ~67 ms, a prime stride spreads them over the slots */
+			soft_timer_start(&bench_timers[i], SOFT_TIMER_MS(2) + (rtc_time_t)i * 37, 0, bench_cb);
+		}
+		for (uint8_t i = 1; i < n; i += 2) {
+			soft_timer_cancel(&bench_timers[i]);
+		}
+		while (bench_fired < (n + 1) / 2) {
+			soft_timer_process();
+		}
+
+		soft_timer_bench_cycles[c][0] = bench_avg(PROFILE_TIMER_START);
+		soft_timer_bench_cycles[c][1] = bench_avg(PROFILE_TIMER_CANCEL);
+		soft_timer_bench_cycles[c][2] = bench_avg(PROFILE_TIMER_PROCESS);
+		soft_timer_bench_cycles[c][3] = bench_avg(PROFILE_TIMER_REARM);
+		ok &= (bench_fired == (n + 1) / 2);
+	}
+	return ok;
+}
@@ -0,0 +1,131 @@
+/*
+ * calib_model.c
+ *
+ * Runs the calibration engine (calibRC.c, clkctrl.c) on the host against a
+ * simulated OSC20M and 32 kHz crystal, for the device selected at compile
+ * time. Each simulated unit gets its own factory error and an uneven,
+ * monotonic trim curve around DEVICE_TRIM_STEP_PERMILLE per code.
+ *
+ * Prints, per target: units calibrated, search time (simulated), and the
+ * error left. Fails if a unit is not calibrated within ACCURACY_DEFAULT.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "calibRC.h"
+#include <clkctrl.h>
+
+#define MODEL_UNITS 500
+
+CLKCTRL_t CLKCTRL;
+FUSE_t    FUSE;
+
+static RTC_t  model_rtc;
+static double model_time;                          // Seconds since the unit started
+static double model_osc[1 << DEVICE_TRIM_BITS];    // OSC20M frequency per trim code
+
+/*! \brief The RTC, read by the engine through the RTC macro
+*
+* Each read stands for one Counter() loop: LOOP_CYCLES CPU cycles at the
+* frequency of the trim code in place.
+*/
+RTC_t *host_rtc(void)
+{
+	double cpu = model_osc[CLKCTRL.OSC20MCALIBA & DEVICE_TRIM_MASK] / CLKCTRL_prescaler();
+
+	model_time += LOOP_CYCLES / cpu;
+	model_rtc.CNT = (uint16_t)(model_time * XTAL_FREQUENCY);
+	return &model_rtc;
+}
+
+void protected_write_io(void *addr, uint8_t magic, uint8_t value)
+{
+	(void)magic;
+	*(volatile uint8_t *)addr = value;
+}
+
+static double model_uniform(double lo, double hi)
+{
+	return lo + (hi - lo) * rand() / RAND_MAX;
+}
+
+/*! \brief A new unit: factory code, factory error and trim curve
+*/
+static void model_unit(double nominal)
+{
+	int    codes   = 1 << DEVICE_TRIM_BITS;
+	int    factory = codes / 2 + (rand() % 7) - 3;
+	double step    = DEVICE_TRIM_STEP_PERMILLE / 1000.0;
+	int    i;
+
+	model_osc[factory] = nominal * model_uniform(0.97, 1.03);
+	for (i = factory + 1; i < codes; i++) {
+		model_osc[i] = model_osc[i - 1] * (1 + step * model_uniform(0.6, 1.4));
+	}
+	for (i = factory - 1; i >= 0; i--) {
+		model_osc[i] = model_osc[i + 1] / (1 + step * model_uniform(0.6, 1.4));
+	}
+	CLKCTRL.OSC20MCALIBA = factory;
+	model_time           = model_uniform(0, 1);
+}
+
+/*! \brief Calibrate MODEL_UNITS units to an OSC20M target
+*
+* \return Number of units not calibrated within ACCURACY_DEFAULT
+*/
+static int model_run(const char *name, uint32_t target)
+{
+	double time_max = 0, time_sum = 0, err_max = 0, err_sum = 0;
+	int    ok = 0, i;
+
+	for (i = 0; i < MODEL_UNITS; i++) {
+		double start, err;
+		int8_t ret;
+
+		model_unit(CLKCTRL_osc20m_nominal_hz());
+		InitCalibRc();
+		start = model_time;
+		ret   = CalibSwitchOscillator(&calibDefault, target);
+		start = (model_time - start) * 1000;
+		err   = model_osc[CLKCTRL.OSC20MCALIBA & DEVICE_TRIM_MASK] / target - 1;
+		if (err < 0) {
+			err = -err;
+		}
+		if (ret == 1 && err < 2.0 / 100) {
+			ok++;
+		}
+		time_sum += start;
+		err_sum += err;
+		if (start > time_max) {
+			time_max = start;
+		}
+		if (err > err_max) {
+			err_max = err;
+		}
+	}
+	printf("%-22s %2d-bit trim, %8lu Hz: %d/%d calibrated, %.1f ms mean / %.1f ms max, "
+	       "error %.2f%% mean / %.2f%% max\n",
+	       name, DEVICE_TRIM_BITS, (unsigned long)target, ok, MODEL_UNITS, time_sum / MODEL_UNITS,
+	       time_max, 100 * err_sum / MODEL_UNITS, 100 * err_max);
+	return MODEL_UNITS - ok;
+}
+
+int main(void)
+{
+	int failed = 0;
+
+	srand(817);
+	CLKCTRL.MCLKSTATUS = CLKCTRL_XOSC32KS_bm;
+	CLKCTRL.MCLKCTRLB  = CLKCTRL_PDIV_4X_gc | CLKCTRL_PEN_bm;
+
+	FUSE.OSCCFG = FUSE_FREQSEL_20MHZ_gc;
+	failed += model_run(MODEL_NAME " 20 MHz fuse", 20000000UL);
+	failed += model_run(MODEL_NAME " 20 MHz fuse", 16000000UL);
+	FUSE.OSCCFG = FUSE_FREQSEL_16MHZ_gc;
+	failed += model_run(MODEL_NAME " 16 MHz fuse", 16000000UL);
+#ifdef MODEL_OVERCLOCK
+	FUSE.OSCCFG = FUSE_FREQSEL_20MHZ_gc;
+	failed += model_run(MODEL_NAME " 20 MHz fuse", MODEL_OVERCLOCK);
+#endif
+	return failed != 0;
+}
@@ -0,0 +1,180 @@
+/*
+ * soft_timer_test.c
+ *
+ * Runs soft_timer.c on the host against a simulated RTC: the time only
+ * moves when the test says so, the compare fires once the time reached
+ * the programmed deadline, as the RTC interrupt would.
+ *
+ * Each case checks how late every timer fired. Fails on the first timer
+ * that fired too late, or not at all.
+ */
+
+#include <stdio.h>
+#include "soft_timer.h"
+
+volatile RTC_0_ovf_t RTC_0_ovf_count;
+
+static RTC_t      test_rtc;
+static rtc_time_t test_now;
+static rtc_time_t test_cmp;
+static rtc_cb_t   test_cmp_cb;
+
+/*! \brief The RTC, read by RTC_0_now() through the RTC macro
+*/
+RTC_t *host_rtc(void)
+{
+	test_rtc.CNT = (uint16_t)test_now;
+	return &test_rtc;
+}
+
+/*! \brief Set the time, the overflow count follows as with its interrupt
+*/
+static void test_set_time(rtc_time_t now)
+{
+	test_now        = now;
+	RTC_0_ovf_count = now >> 16;
+}
+
+int8_t RTC_0_set_compare(rtc_time_t deadline, rtc_cb_t cb)
+{
+	test_cmp_cb = NULL;
+	if ((rtc_stime_t)(deadline - test_now) < RTC_0_CMP_MIN_TICKS) {
+		return -1;
+	}
+	test_cmp    = deadline;
+	test_cmp_cb = cb;
+	return 0;
+}
+
+void RTC_0_cancel_compare(void)
+{
+	test_cmp_cb = NULL;
+}
+
+/*! \brief One RTC tick, then the compare interrupt and a main loop pass
+*/
+static void test_tick(void)
+{
+	rtc_cb_t cb = test_cmp_cb;
+
+	test_set_time(test_now + 1);
+	if (cb && (rtc_stime_t)(test_now - test_cmp) >= 0) {
+		test_cmp_cb = NULL;
+		cb();
+	}
+	soft_timer_process();
+}
+
+static soft_timer_t test_long, test_oneshot, test_periodic;
+static rtc_time_t   test_fired;
+static rtc_time_t   test_long_ticks;
+
+static void test_long_cb(soft_timer_t *timer)
+{
+	(void)timer;
+	test_set_time(test_now + test_long_ticks); /* A callback running this long, e.g. a recalibration */
+}
+
+static void test_oneshot_cb(soft_timer_t *timer)
+{
+	(void)timer;
+	test_fired = test_now;
+}
+
+static void test_periodic_cb(soft_timer_t *timer)
+{
+	(void)timer;
+}
+
+/*! \brief A one-shot due while a long callback runs, a periodic timer ahead
+*
+* When the long callback returns the one-shot is overdue and its slot is
+* behind the current one, while the periodic timer is due ahead of it. The
+* one-shot must run right after the long callback, not once the wheel came
+* back round to its slot.
+*
+* \return 0, or 1 if the one-shot was late
+*/
+static int test_due_during_callback(rtc_time_t start, rtc_time_t period_slots)
+{
+	rtc_time_t due, end;
+
+	test_set_time(start);
+	test_fired      = 0;
+	test_long_ticks = SOFT_TIMER_MS(20);
+	soft_timer_init();
+	soft_timer_start(&test_long, 100, 0, test_long_cb);
+	soft_timer_start(&test_oneshot, 100 + test_long_ticks / 2, 0, test_oneshot_cb);
+	/* First due after the long callback: ahead of the one-shot in the wheel */
+	soft_timer_start(&test_periodic, 100 + test_long_ticks + 10, period_slots << SOFT_TIMER_SLOT_SHIFT,
+	                 test_periodic_cb);
+	due = start + 100 + test_long_ticks / 2;
+	end = start + 100 + test_long_ticks;
+
+	while (!test_fired && (rtc_stime_t)(test_now - end) < 2000) {
+		test_tick();
+	}
+	soft_timer_cancel(&test_long);
+	soft_timer_cancel(&test_oneshot);
+	soft_timer_cancel(&test_periodic);
+	printf("due during a %lu tick callback, periodic every %lu slots: ", (unsigned long)test_long_ticks,
+	       (unsigned long)period_slots);
+	if (!test_fired) {
+		printf("never fired\n");
+		return 1;
+	}
+	printf("%ld ticks late, %ld after the callback\n", (long)(rtc_stime_t)(test_fired - due),
+	       (long)(rtc_stime_t)(test_fired - end));
+	return (rtc_stime_t)(test_fired - end) > 1;
+}
+
+static soft_timer_t test_many[SOFT_TIMER_SLOTS * 3];
+static rtc_time_t   test_expected[SOFT_TIMER_SLOTS * 3];
+static rtc_time_t   test_late_max;
+static int          test_missing;
+
+static void test_many_cb(soft_timer_t *timer)
+{
+	rtc_time_t late = test_now - test_expected[timer - &test_many[0]];
+
+	if (late > test_late_max) {
+		test_late_max = late;
+	}
+	test_missing--;
+}
+
+/*! \brief Timers spread over three turns of the wheel all fire on time
+*/
+static int test_spread(rtc_time_t start)
+{
+	uint16_t i;
+
+	test_set_time(start);
+	test_late_max = 0;
+	test_missing  = ARRAY_SIZE(test_many);
+	soft_timer_init();
+	for (i = 0; i < ARRAY_SIZE(test_many); i++) {
+		rtc_time_t delay = 5 + (rtc_time_t)i * 37;
+
+		test_expected[i] = test_now + delay;
+		soft_timer_start(&test_many[i], delay, 0, test_many_cb);
+	}
+	while (test_missing && (rtc_stime_t)(test_now - start) < 100000) {
+		test_tick();
+	}
+	printf("%u timers over three turns: %d missing, %lu ticks late at most\n", (unsigned)ARRAY_SIZE(test_many),
+	       test_missing, (unsigned long)test_late_max);
+	return test_missing || test_late_max > 1;
+}
+
+int main(void)
+{
+	int failed = 0;
+
+	failed += test_due_during_callback(0, 2);
+	failed += test_due_during_callback(0xFFFF0000UL, 2); /* Across the 32-bit wrap */
+	failed += test_due_during_callback(12345, 5);
+	failed += test_spread(0);
+	failed += test_spread(0xFFFFF000UL);
+	return failed != 0;
+}
@@ -0,0 +1,2 @@
+/* Host stand-in for the avr-libc header */
+#define __builtin_avr_delay_cycles(n) ((void)(n))
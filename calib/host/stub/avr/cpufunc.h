@@ -0,0 +1,2 @@
+/* Host stand-in for the avr-libc header */
+#define _NOP() do{}while(0)
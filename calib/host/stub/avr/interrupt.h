@@ -0,0 +1,8 @@
+/* Host stand-in for the avr-libc header */
+#define ISR(v, ...) void v(void); void v(void)
+#define ISR_NAKED
+#define ISR_BLOCK
+#define ISR_NOBLOCK
+#define sei() do{}while(0)
+#define cli() do{}while(0)
+#define reti() do{}while(0)
@@ -0,0 +1,236 @@
+/* Host stand-in for the AVR device header: only what the sources use */
+#include <stdint.h>
+typedef volatile uint8_t register8_t;
+typedef volatile uint16_t register16_t;
+typedef volatile uint32_t register32_t;
+#define _SFR_IO_ADDR(x) ((uint16_t)(uintptr_t)&(x))
+#define _SFR_MEM_ADDR(x) ((uint16_t)(uintptr_t)&(x))
+extern register8_t CCP, SREG, GPIOR0, GPIOR1, GPIOR2, GPIOR3;
+#define CCP_IOREG_gc 0xD8
+#define CCP_SPM_gc 0x9D
+/* Per-device guard: the tinyAVR 0-series and the 8-pin 1-series parts have
+ * no 32.768 kHz crystal oscillator, their avr-libc headers lack these names */
+#if !(defined(__AVR_ATtiny202__) || defined(__AVR_ATtiny204__) || defined(__AVR_ATtiny402__) \
+      || defined(__AVR_ATtiny404__) || defined(__AVR_ATtiny406__) || defined(__AVR_ATtiny804__) \
+      || defined(__AVR_ATtiny806__) || defined(__AVR_ATtiny807__) || defined(__AVR_ATtiny1604__) \
+      || defined(__AVR_ATtiny1606__) || defined(__AVR_ATtiny1607__) || defined(__AVR_ATtiny212__) \
+      || defined(__AVR_ATtiny412__))
+#define STUB_XOSC32K
+#endif
+#ifdef STUB_XOSC32K
+typedef struct { register8_t MCLKCTRLA, MCLKCTRLB, MCLKLOCK, MCLKSTATUS, OSC20MCTRLA, OSC20MCALIBA, OSC20MCALIBB, OSC32KCTRLA, XOSC32KCTRLA; } CLKCTRL_t;
+#else
+typedef struct { register8_t MCLKCTRLA, MCLKCTRLB, MCLKLOCK, MCLKSTATUS, OSC20MCTRLA, OSC20MCALIBA, OSC20MCALIBB, OSC32KCTRLA, reserved; } CLKCTRL_t;
+#endif
+extern CLKCTRL_t CLKCTRL;
+#define CLKCTRL_CSUT_1K_gc 0
+#define CLKCTRL_ENABLE_bp 0
+#define CLKCTRL_ENABLE_bm 1
+#define CLKCTRL_RUNSTDBY_bp 1
+#define CLKCTRL_RUNSTDBY_bm 2
+#define CLKCTRL_SEL_bp 2
+#define CLKCTRL_PDIV_4X_gc (1<<1)
+#define CLKCTRL_PDIV_gm 0x1E
+#define CLKCTRL_PDIV_gp 1
+#define CLKCTRL_PEN_bp 0
+#define CLKCTRL_PEN_bm 1
+#ifdef STUB_XOSC32K
+#define CLKCTRL_XOSC32KS_bm 0x40
+#endif
+#define CLKCTRL_CLKSEL_OSC20M_gc 0
+#define CLKCTRL_CLKSEL_gm 3
+#define CLKCTRL_SOSC_bm 1
+#define CLKCTRL_LOCK_bm 0x80
+typedef struct { register8_t CTRLA, STATUS, INTCTRL, INTFLAGS, TEMP, DBGCTRL, CLKSEL; register16_t CNT, PER, CMP; register8_t PITCTRLA, PITSTATUS, PITINTCTRL, PITINTFLAGS, PITDBGCTRL; } RTC_t;
+#ifdef HOST_MODEL
+/* Every access moves the simulated time on, see calib_model.c */
+RTC_t *host_rtc(void);
+#define RTC (*host_rtc())
+#else
+extern RTC_t RTC;
+#endif
+#define RTC_PRESCALER_DIV1_gc 0
+#define RTC_RTCEN_bp 0
+#define RTC_RTCEN_bm 1
+#define RTC_RUNSTDBY_bp 7
+#define RTC_RUNSTDBY_bm 0x80
+#ifdef STUB_XOSC32K
+#define RTC_CLKSEL_TOSC32K_gc 2
+#endif
+#define RTC_OVF_bm 1
+#define RTC_CMP_bm 2
+#define RTC_OVF_bp 0
+#define RTC_CMP_bp 1
+#define RTC_PI_bm 1
+#define RTC_PITEN_bm 1
+#define RTC_PITEN_bp 0
+#define RTC_PERIOD_gm 0x78
+#define RTC_CMPBUSY_bm 8
+#define RTC_CNTBUSY_bm 2
+#define RTC_PERBUSY_bm 4
+#define RTC_CTRLABUSY_bm 1
+#define RTC_CTRLBUSY_bm 1
+typedef enum { RTC_PERIOD_OFF_gc=0, RTC_PERIOD_CYC4_gc=8, RTC_PERIOD_CYC8_gc=0x10, RTC_PERIOD_CYC16_gc=0x18,RTC_PERIOD_CYC32_gc=0x20,RTC_PERIOD_CYC64_gc=0x28,RTC_PERIOD_CYC128_gc=0x30,RTC_PERIOD_CYC256_gc=0x38,RTC_PERIOD_CYC512_gc=0x40,RTC_PERIOD_CYC1024_gc=0x48,RTC_PERIOD_CYC2048_gc=0x50,RTC_PERIOD_CYC4096_gc=0x58,RTC_PERIOD_CYC8192_gc=0x60,RTC_PERIOD_CYC16384_gc=0x68,RTC_PERIOD_CYC32768_gc=0x70 } RTC_PERIOD_t;
+typedef struct { register8_t CTRLA, CTRLB, CTRLC, CTRLD, CTRLECLR, CTRLESET, CTRLFCLR, CTRLFSET, EVCTRL, INTCTRL, INTFLAGS, DBGCTRL, TEMP; register16_t CNT, PER, CMP0, CMP1, CMP2, PERBUF, CMP0BUF, CMP1BUF, CMP2BUF; } TCA_SINGLE_t;
+typedef struct { register8_t CTRLA, CTRLB, CTRLC, CTRLD, CTRLECLR, CTRLESET, INTCTRL, INTFLAGS, DBGCTRL, LCNT, HCNT, LPER, HPER, LCMP0, HCMP0, LCMP1, HCMP1, LCMP2, HCMP2; } TCA_SPLIT_t;
+typedef union { TCA_SINGLE_t SINGLE; TCA_SPLIT_t SPLIT; } TCA_t;
+extern TCA_t TCA0;
+#define TCA_SINGLE_ALUPD_bp 3
+#define TCA_SINGLE_CMP0EN_bp 4
+#define TCA_SINGLE_CMP1EN_bp 5
+#define TCA_SINGLE_CMP2EN_bp 6
+#define TCA_SINGLE_CMP0EN_bm 0x10
+#define TCA_SINGLE_CMP1EN_bm 0x20
+#define TCA_SINGLE_CMP2EN_bm 0x40
+#define TCA_SINGLE_WGMODE_gm 7
+typedef enum { TCA_SINGLE_WGMODE_NORMAL_gc=0, TCA_SINGLE_WGMODE_FRQ_gc=1, TCA_SINGLE_WGMODE_SINGLESLOPE_gc=3, TCA_SINGLE_WGMODE_DSTOP_gc=5, TCA_SINGLE_WGMODE_DSBOTH_gc=6, TCA_SINGLE_WGMODE_DSBOTTOM_gc=7 } TCA_SINGLE_WGMODE_t;
+#define TCA_SINGLE_CLKSEL_gm 0x0E
+typedef enum { TCA_SINGLE_CLKSEL_DIV1_gc=0, TCA_SINGLE_CLKSEL_DIV2_gc=2, TCA_SINGLE_CLKSEL_DIV4_gc=4, TCA_SINGLE_CLKSEL_DIV8_gc=6, TCA_SINGLE_CLKSEL_DIV16_gc=8, TCA_SINGLE_CLKSEL_DIV64_gc=10, TCA_SINGLE_CLKSEL_DIV256_gc=12, TCA_SINGLE_CLKSEL_DIV1024_gc=14 } TCA_SINGLE_CLKSEL_t;
+#define TCA_SINGLE_ENABLE_bp 0
+#define TCA_SINGLE_ENABLE_bm 1
+#define TCA_SINGLE_OVF_bm 1
+#define TCA_SINGLE_OVF_bp 0
+#define TCA_SINGLE_CMP0_bm 0x10
+#define TCA_SINGLE_CMP1_bm 0x20
+#define TCA_SINGLE_CMP2_bm 0x40
+#define TCA_SINGLE_LUPD_bm 2
+#define TCA_SINGLE_CMD_gm 0x0C
+#define TCA_SINGLE_CMD_RESET_gc 0x0C
+#define TCA_SINGLE_CMD_UPDATE_gc 0x04
+#define TCA_SINGLE_CMD_RESTART_gc 0x08
+#define TCA_SINGLE_CMDEN_gm 0xC0
+#define TCA_SINGLE_SPLITM_bm 1
+#define TCA_SPLIT_SPLITM_bm 1
+#define TCA_SPLIT_ENABLE_bm 1
+#define TCA_SPLIT_ENABLE_bp 0
+#define TCA_SPLIT_CLKSEL_gm 0x0E
+typedef enum { TCA_SPLIT_CLKSEL_DIV1_gc=0, TCA_SPLIT_CLKSEL_DIV2_gc=2, TCA_SPLIT_CLKSEL_DIV4_gc=4, TCA_SPLIT_CLKSEL_DIV8_gc=6, TCA_SPLIT_CLKSEL_DIV16_gc=8, TCA_SPLIT_CLKSEL_DIV64_gc=10, TCA_SPLIT_CLKSEL_DIV256_gc=12, TCA_SPLIT_CLKSEL_DIV1024_gc=14 } TCA_SPLIT_CLKSEL_t;
+#define TCA_SPLIT_LCMP0EN_bm 1
+#define TCA_SPLIT_LCMP1EN_bm 2
+#define TCA_SPLIT_LCMP2EN_bm 4
+#define TCA_SPLIT_HCMP0EN_bm 0x10
+#define TCA_SPLIT_HCMP1EN_bm 0x20
+#define TCA_SPLIT_HCMP2EN_bm 0x40
+#define TCA_SPLIT_CMD_RESET_gc 0x0C
+#define TCA_SPLIT_CMDEN_BOTH_gc 0x03
+#define TCA_SINGLE_CMDEN_BOTH_gc 0x03
+#define TCA_SPLIT_LUNF_bm 1
+typedef struct { register8_t CTRLA, CTRLB, EVCTRL, INTCTRL, INTFLAGS, STATUS, DBGCTRL, TEMP; register16_t CNT, CCMP; } TCB_t;
+extern TCB_t TCB0;
+#define TCB_CNTMODE_INT_gc 0
+#define TCB_CLKSEL_CLKDIV1_gc 0
+#define TCB_ENABLE_bp 0
+#define TCB_ENABLE_bm 1
+#define TCB_CAPT_bm 1
+#define TCB_RUNSTDBY_bm 0x40
+typedef struct { register8_t DIR, DIRSET, DIRCLR, DIRTGL, OUT, OUTSET, OUTCLR, OUTTGL, IN, INTFLAGS, r[6], PIN0CTRL, PIN1CTRL, PIN2CTRL, PIN3CTRL, PIN4CTRL, PIN5CTRL, PIN6CTRL, PIN7CTRL; } PORT_t;
+extern PORT_t PORTA, PORTB, PORTC;
+#define PORT_PULLUPEN_bp 3
+#define PORT_PULLUPEN_bm 8
+#define PORT_INVEN_bm 0x80
+#define PORT_ISC_gm 7
+typedef enum { PORT_ISC_INTDISABLE_gc=0, PORT_ISC_BOTHEDGES_gc=1, PORT_ISC_RISING_gc=2, PORT_ISC_FALLING_gc=3, PORT_ISC_INPUT_DISABLE_gc=4, PORT_ISC_LEVEL_gc=5 } PORT_ISC_t;
+typedef struct { register8_t CTRLA, STATUS, LVL0PRI, LVL1VEC; } CPUINT_t;
+extern CPUINT_t CPUINT;
+#define CPUINT_CVT_bp 5
+#define CPUINT_CVT_bm 0x20
+#define CPUINT_IVSEL_bp 6
+#define CPUINT_IVSEL_bm 0x40
+#define CPUINT_LVL0RR_bp 0
+#define CPUINT_LVL0RR_bm 1
+#define CPUINT_LVL0PRI_gp 0
+#define CPUINT_LVL1VEC_gp 0
+#define CPUINT_LVL0EX_bm 1
+#define CPUINT_LVL1EX_bm 2
+#define CPUINT_NMIEX_bm 0x80
+typedef struct { register8_t CTRLA; } SLPCTRL_t;
+extern SLPCTRL_t SLPCTRL;
+#define SLPCTRL_SEN_bp 0
+#define SLPCTRL_SEN_bm 1
+#define SLPCTRL_SMODE_gm 6
+typedef enum { SLPCTRL_SMODE_IDLE_gc=0, SLPCTRL_SMODE_STDBY_gc=2, SLPCTRL_SMODE_PDOWN_gc=4 } SLPCTRL_SMODE_t;
+typedef struct { register8_t CTRLA, CTRLB, r[6], VLMCTRLA, INTCTRL, INTFLAGS, STATUS; } BOD_t;
+extern BOD_t BOD;
+#define BOD_VLMIE_bp 0
+#define BOD_VLMIE_bm 1
+#define BOD_VLMIF_bm 1
+#define BOD_VDDS_bm 1
+#define BOD_VLMCFG_gm 6
+typedef enum { BOD_VLMCFG_BELOW_gc=0, BOD_VLMCFG_ABOVE_gc=2, BOD_VLMCFG_CROSS_gc=4 } BOD_VLMCFG_t;
+#define BOD_VLMLVL_gm 3
+typedef enum { BOD_VLMLVL_5ABOVE_gc=0, BOD_VLMLVL_15ABOVE_gc=1, BOD_VLMLVL_25ABOVE_gc=2 } BOD_VLMLVL_t;
+#define BOD_SLEEP_DIS_gc 0
+typedef struct { register8_t CTRLA, CTRLB, CTRLC, CTRLD, CTRLE, SAMPCTRL, MUXPOS, r, COMMAND, EVCTRL, INTCTRL, INTFLAGS, DBGCTRL, TEMP, r2[2]; register16_t RES, WINLT, WINHT; register8_t CALIB; } ADC_t;
+extern ADC_t ADC0;
+#define ADC_ENABLE_bm 1
+#define ADC_STCONV_bm 1
+#define ADC_RESRDY_bm 1
+#define ADC_SAMPCAP_bm 0x40
+#define ADC_REFSEL_INTREF_gc 0
+#define ADC_PRESC_DIV16_gc 3
+#define ADC_INITDLY_DLY32_gc 0x20
+#define ADC_MUXPOS_TEMPSENSE_gc 0x1E
+#define ADC_SAMPNUM_ACC1_gc 0
+#define ADC_ASDV_bm 0x10
+typedef struct { register8_t CTRLA; } VREF_t;
+extern VREF_t VREF;
+#define VREF_ADC0REFSEL_gm 0x70
+#define VREF_ADC0REFSEL_1V1_gc 0x10
+typedef struct { register8_t CTRLA, CTRLB, CTRLC, CTRLD, CTRLE, r[3], EVCTRLA, EVCTRLB, r2[2], INTCTRL, INTFLAGS, STATUS, r3, INPUTCTRLA, INPUTCTRLB, FAULTCTRL, r4, DLYCTRL, DLYVAL, r5[2], DITCTRL, DITVAL, r6[4], DBGCTRL, r7[3]; register16_t CAPTUREA, CAPTUREB, r8, CMPASET, CMPACLR, CMPBSET, CMPBCLR; } TCD_t;
+extern TCD_t TCD0;
+#define TCD_ENABLE_bm 1
+#define TCD_ENRDY_bm 1
+#define TCD_CMDRDY_bm 2
+#define TCD_SYNCEOC_bm 1
+#define TCD_SYNC_bm 2
+#define TCD_CLKSEL_gm 0x60
+#define TCD_CLKSEL_20MHZ_gc 0
+#define TCD_CLKSEL_SYSCLK_gc 0x60
+#define TCD_CNTPRES_gm 0x18
+#define TCD_CNTPRES_DIV1_gc 0
+#define TCD_CNTPRES_DIV4_gc 8
+#define TCD_CNTPRES_DIV32_gc 0x10
+#define TCD_SYNCPRES_DIV1_gc 0
+#define TCD_WGMODE_gm 3
+typedef enum { TCD_WGMODE_ONERAMP_gc=0, TCD_WGMODE_TWORAMP_gc=1, TCD_WGMODE_FOURRAMP_gc=2, TCD_WGMODE_DS_gc=3 } TCD_WGMODE_t;
+#define TCD_CMPAEN_bm 0x10
+#define TCD_CMPBEN_bm 0x20
+#define TCD_CMPA_bm 1
+#define TCD_CMPB_bm 2
+#define TCD_OVF_bm 1
+typedef struct { register8_t CTRLA, CTRLB, CTRLC, CTRLD; } PORTMUX_t;
+extern PORTMUX_t PORTMUX;
+#define PORTMUX_TCA00_bm 1
+#define PORTMUX_TCA01_bm 2
+#define PORTMUX_TCA02_bm 4
+#define PORTMUX_TCA03_bm 8
+#define PORTMUX_TCA04_bm 0x10
+#define PORTMUX_TCA05_bm 0x20
+typedef struct { register8_t WDTCFG, BODCFG, OSCCFG; } FUSE_t;
+extern FUSE_t FUSE;
+#define FUSE_FREQSEL_gm 3
+#define FUSE_FREQSEL_16MHZ_gc 1
+#define FUSE_FREQSEL_20MHZ_gc 2
+typedef struct { register8_t RSTFR, SWRR; } RSTCTRL_t;
+extern RSTCTRL_t RSTCTRL;
+#define RSTCTRL_BORF_bm 2
+typedef struct { register8_t DEVICEID0, DEVICEID1, DEVICEID2, SERNUM[10], r[3], TEMPSENSE0, TEMPSENSE1, OSC16ERR3V, OSC16ERR5V, OSC20ERR3V, OSC20ERR5V; } SIGROW_t;
+extern SIGROW_t SIGROW;
+#define TCA0_OVF_vect __vector_8
+#define TCA0_OVF_vect_num 8
+#define TCA0_CMP1_vect __vector_11
+#define RTC_CNT_vect __vector_6
+#define RTC_CNT_vect_num 6
+#define RTC_PIT_vect __vector_7
+#define RTC_PIT_vect_num 7
+#define BOD_VLM_vect __vector_2
+#define BOD_VLM_vect_num 2
+#define TCB0_INT_vect __vector_13
+#define TCB0_INT_vect_num 13
+#define PORTA_PORT_vect __vector_3
+#define __AVR_XMEGA__ 1
+#define RAMSTART 0x3E00
+#define RAMEND 0x3FFF
+typedef struct { register8_t DIR, OUT, IN, INTFLAGS; } VPORT_t;
+extern VPORT_t VPORTA, VPORTB, VPORTC;
+#define TCA_SINGLE_CLKSEL_gp 1
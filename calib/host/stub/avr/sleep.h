@@ -0,0 +1,4 @@
+/* Host stand-in for the avr-libc header */
+#define sleep_enable() do{}while(0)
+#define sleep_disable() do{}while(0)
+#define sleep_cpu() do{}while(0)
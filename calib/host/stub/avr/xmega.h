@@ -0,0 +1,2 @@
+/* Host stand-in for the avr-libc header */
+#define _PROTECTED_WRITE(reg, value) ((reg) = (value))
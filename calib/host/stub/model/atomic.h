@@ -0,0 +1,10 @@
+/* Host stand-in for utils/atomic.h: there are no interrupts to hold off */
+#ifndef ATOMIC_H
+#define ATOMIC_H
+
+#define ENTER_CRITICAL(UNUSED) ((void)0)
+#define EXIT_CRITICAL(UNUSED) ((void)0)
+#define DISABLE_INTERRUPTS() ((void)0)
+#define ENABLE_INTERRUPTS() ((void)0)
+
+#endif /* ATOMIC_H */
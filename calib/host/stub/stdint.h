@@ -0,0 +1,14 @@
+/* Host stand-in: the AVR integer types, long is the 32-bit type as in avr-gcc */
+#ifndef STUB_STDINT
+#define STUB_STDINT
+typedef signed char int8_t; typedef unsigned char uint8_t;
+typedef short int16_t; typedef unsigned short uint16_t;
+typedef long int32_t; typedef unsigned long uint32_t;
+typedef long long int64_t; typedef unsigned long long uint64_t;
+typedef unsigned long uintptr_t; /* Wide enough for host pointers */
+#define UINT8_MAX 255
+#define UINT16_MAX 65535
+#define UINT32_MAX 0xFFFFFFFFUL
+#define INT16_MAX 32767
+#define INT32_MAX 0x7FFFFFFFL
+#endif
@@ -0,0 +1,7 @@
+/* Host stand-in: keeps the C library from redefining the stub/stdint.h types */
+#include <stddef.h>
+int abs(int);
+long labs(long);
+int rand(void);
+void srand(unsigned int seed);
+#define RAND_MAX 2147483647
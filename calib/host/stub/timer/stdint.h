@@ -0,0 +1,15 @@
+/* Host stand-in for the soft timer test: uint32_t is 32 bits wide here so
+ * the RTC time wraps as on the AVR (stub/stdint.h makes it a host long) */
+#ifndef STUB_STDINT
+#define STUB_STDINT
+typedef signed char int8_t; typedef unsigned char uint8_t;
+typedef short int16_t; typedef unsigned short uint16_t;
+typedef int int32_t; typedef unsigned int uint32_t;
+typedef long long int64_t; typedef unsigned long long uint64_t;
+typedef unsigned long uintptr_t; /* Wide enough for host pointers */
+#define UINT8_MAX 255
+#define UINT16_MAX 65535
+#define UINT32_MAX 0xFFFFFFFFU
+#define INT16_MAX 32767
+#define INT32_MAX 0x7FFFFFFF
+#endif
@@ -0,0 +1,3 @@
+/* Host stand-in for the avr-libc header */
+static inline void _delay_ms(double x){(void)x;}
+static inline void _delay_us(double x){(void)x;}
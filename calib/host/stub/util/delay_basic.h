@@ -0,0 +1,3 @@
+/* Host stand-in for the avr-libc header */
+static inline void _delay_loop_2(unsigned short x){(void)x;}
+static inline void _delay_loop_1(unsigned char x){(void)x;}
@@ -34,8 +34,40 @@
 extern "C" {
 #endif
 
+typedef void (*bod_cb_t)(void);
+
+/**
+ * Supply bands told apart by the three VLM thresholds, from the BOD level:
+ * band 0 below +5% (close to brown-out), 1 below +15%, 2 below +25%, 3 above.
+ */
+#define BOD_VLM_BANDS 4
+
+/** Settling time of the VLM after a threshold change, in us */
+#define BOD_VLM_SETTLE_US 10
+
+/** VLM callback, only called while the VLM interrupt is enabled */
+extern bod_cb_t BOD_vlm_cb;
+
 int8_t BOD_init();
 
+void BOD_vlm_enable(BOD_VLMLVL_t level, BOD_VLMCFG_t cfg, bod_cb_t cb);
+
+void BOD_vlm_disable(void);
+
+uint8_t BOD_vlm_band(void);
+
+void BOD_vlm_watch_band(uint8_t band);
+
+/**
+ * \brief Check if VDD is below the VLM threshold
+ *
+ * Only valid while the BOD is enabled (BODCFG fuse).
+ */
+static inline uint8_t BOD_vdd_below_vlm(void)
+{
+	return BOD.STATUS & BOD_VDDS_bm;
+}
+
 #ifdef __cplusplus
 }
 #endif
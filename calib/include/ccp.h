@@ -30,6 +30,9 @@
 
 #include <compiler.h>
 #include <protected_io.h>
+#if defined(__GNUC__)
+#include <avr/xmega.h>
+#endif
 
 #ifdef __cplusplus
 extern "C" {
@@ -52,6 +55,21 @@ static inline void ccp_write_io(void *addr, uint8_t value)
 
 /** @} */
 
+/**
+ * \brief Write to a CCP-protected 8-bit I/O register at a compile-time address
+ *
+ * avr-libc's _PROTECTED_WRITE() from <avr/xmega.h>, expanded in place
+ * instead of calling protected_write_io().
+ *
+ * \param reg   The register itself, e.g. CLKCTRL.OSC20MCALIBA
+ * \param value Value to be written
+ */
+#if defined(__GNUC__)
+#define ccp_write_io_inline(reg, value) _PROTECTED_WRITE(reg, value)
+#else
+#define ccp_write_io_inline(reg, value) ccp_write_io((void *)&(reg), (value))
+#endif
+
 /**
  * \brief Write to CCP-protected 8-bit SPM register
  *
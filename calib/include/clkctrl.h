@@ -29,13 +29,35 @@
 #define CLKCTRL_H_INCLUDED
 
 #include <compiler.h>
+#include <init_table.h>
 
 #ifdef __cplusplus
 extern "C" {
 #endif
 
+/**
+ * \brief CLKCTRL configuration, applied by CLKCTRL_init() and by system_init()
+ *
+ * XOSC32K comes first so the crystal starts as early as possible.
+ */
+#define CLKCTRL_INIT_TABLE                                                                                             \
+	INIT_REG_CCP(CLKCTRL.XOSC32KCTRLA,                                                                                 \
+	             CLKCTRL_CSUT_1K_gc             /* 1k cycles */                                                    \
+	                 | 1 << CLKCTRL_ENABLE_bp   /* Enable: enabled */                                              \
+	                 | 0 << CLKCTRL_RUNSTDBY_bp /* Run standby: disabled */                                        \
+	                 | 0 << CLKCTRL_SEL_bp /* Select: disabled */),                                                \
+	    INIT_REG_CCP(CLKCTRL.MCLKCTRLB,                                                                            \
+	                 CLKCTRL_PDIV_4X_gc /* 4 */                                                                    \
+	                     | 1 << CLKCTRL_PEN_bp /* Prescaler enable: enabled */)
+
 int8_t CLKCTRL_init();
 
+int8_t CLKCTRL_wait_xosc32k_stable(uint16_t timeout_ms);
+
+uint32_t CLKCTRL_osc20m_nominal_hz(void);
+
+uint8_t CLKCTRL_prescaler(void);
+
 #ifdef __cplusplus
 }
 #endif
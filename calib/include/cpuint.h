@@ -34,8 +34,28 @@
 extern "C" {
 #endif
 
+/**
+ * Configuration applied by CPUINT_init()
+ *
+ * CPUINT_LVL1_VECTOR: vector number given level 1 (high priority), it
+ * preempts every level 0 handler. 0 for none.
+ * CPUINT_ROUND_ROBIN: 1 to rotate the level 0 priority after each
+ * interrupt, so no level 0 source can starve the others.
+ * CPUINT_LVL0_PRIORITY: with static priority, the vector number after
+ * which the level 0 priority starts (0 = lowest vector number first).
+ */
+#define CPUINT_LVL1_VECTOR 0
+#define CPUINT_ROUND_ROBIN 0
+#define CPUINT_LVL0_PRIORITY 0
+
 int8_t CPUINT_init();
 
+void CPUINT_set_level1_vector(uint8_t vector_num);
+
+void CPUINT_set_level0_priority(uint8_t vector_num);
+
+void CPUINT_set_round_robin(uint8_t enable);
+
 #ifdef __cplusplus
 }
 #endif
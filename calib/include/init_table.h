@@ -0,0 +1,42 @@
+/*
+ * init_table.h
+ */
+
+
+#ifndef INIT_TABLE_H_
+#define INIT_TABLE_H_
+
+#include <compiler.h>
+#include <utils.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*! One register store of an initialization table.
+ * The table is const, so on tinyAVR it stays in (memory mapped) flash.
+ */
+typedef struct {
+	register8_t *addr;		// First register to write
+	uint8_t      value;		// Value written
+	uint8_t      flags;		// INIT_TABLE_CCP, or number of consecutive registers to fill
+} init_table_entry_t;
+
+//! The register is Configuration Change Protected, written through protected_write_io()
+#define INIT_TABLE_CCP 0x80
+
+/*! Entry builders, the table is laid out in the order the stores must happen */
+#define INIT_REG(reg, val) {&(reg), (uint8_t)(val), 1}
+#define INIT_REG_CCP(reg, val) {&(reg), (uint8_t)(val), INIT_TABLE_CCP}
+#define INIT_FILL(reg, val, n) {&(reg), (uint8_t)(val), (n)}
+//! 16-bit registers go through TEMP, low byte must be written first
+#define INIT_REG16(reg, val)                                                                                           \
+	{(register8_t *)&(reg), (uint8_t)(val), 1}, {(register8_t *)&(reg) + 1, (uint8_t)((val) >> 8), 1}
+
+void init_table_apply(const init_table_entry_t *entry, uint8_t n);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* INIT_TABLE_H_ */
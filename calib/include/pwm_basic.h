@@ -29,6 +29,7 @@
 #define PWM_BASIC_H_INCLUDED
 
 #include <compiler.h>
+#include <init_table.h>
 
 #ifdef __cplusplus
 extern "C" {
@@ -36,13 +37,77 @@ extern "C" {
 
 typedef void (*pwm_irq_cb_t)(void);
 
-#define PWM_0_INTERRUPT_CB_RATE 0
+/**
+ * Number of TCA0 overflows between two callbacks, 1 to 255.
+ * With 1 the vector calls the callback directly. Above 1 a naked vector
+ * counts down in GPIOR3 and only enters the full C context on the last
+ * overflow, see driver_isr.c.
+ */
+#define PWM_0_INTERRUPT_CB_RATE 1
+
+#if PWM_0_INTERRUPT_CB_RATE < 1 || PWM_0_INTERRUPT_CB_RATE > 255
+#error PWM_0_INTERRUPT_CB_RATE must be 1 to 255
+#endif
+
+/** Overflow callback, only called while registered (OVF interrupt enabled) */
+extern pwm_irq_cb_t PWM_0_cb;
 
 /** The datatype matching the bitwidth of the PWM hardware */
 typedef uint16_t PWM_0_register_t;
 
+/** New TOP and compare values, loaded together by PWM_0_load_all() */
+typedef struct {
+	PWM_0_register_t top;
+	PWM_0_register_t duty[3];
+} PWM_0_update_t;
+
+/** Channel duty not managed by PWM_0_set_duty_permille() */
+#define PWM_0_DUTY_UNMANAGED 0xFFFF
+
+/**
+ * Waveform modes selectable with PWM_0_set_mode()
+ *
+ * Mode         Period (CLK_PER)   Duty         OVF interrupt
+ * SINGLESLOPE  div * (PER + 1)    CMP/(PER+1)  BOTTOM
+ * DSTOP        div * 2 * PER      CMP/PER      TOP
+ * DSBOTTOM     div * 2 * PER      CMP/PER      BOTTOM
+ * DSBOTH       div * 2 * PER      CMP/PER      TOP and BOTTOM
+ *
+ * The dual-slope modes are center aligned: the output is high while
+ * CNT < CMP, symmetric around BOTTOM, so channels switching at the same
+ * carrier do not switch together and the ripple is halved.
+ * All modes take PERBUF/CMPnBUF over at BOTTOM, so a new duty or TOP is
+ * output at most one carrier period after it is written, and the update
+ * itself costs the same in every mode.
+ * DSBOTH calls the overflow callback twice per period.
+ */
+static inline uint8_t PWM_0_is_dual_slope(void)
+{
+	return (TCA0.SINGLE.CTRLB & TCA_SINGLE_WGMODE_gm) >= TCA_SINGLE_WGMODE_DSTOP_gc;
+}
+
+/**
+ * \brief PWM_0 configuration, applied by PWM_0_init() and by system_init()
+ *
+ * The timer is enabled last, once PER and CMP1 are loaded.
+ */
+#define PWM_0_INIT_TABLE                                                                                               \
+	INIT_REG16(TCA0.SINGLE.CMP1, 0x1f4 /* Setting: 0x1f4 */),                                                      \
+	    INIT_REG(TCA0.SINGLE.CTRLB,                                                                                \
+	             0 << TCA_SINGLE_ALUPD_bp            /* Auto Lock Update: disabled */                              \
+	                 | 0 << TCA_SINGLE_CMP0EN_bp     /* Setting: disabled */                                       \
+	                 | 1 << TCA_SINGLE_CMP1EN_bp     /* Setting: enabled */                                        \
+	                 | 0 << TCA_SINGLE_CMP2EN_bp     /* Setting: disabled */                                       \
+	                 | TCA_SINGLE_WGMODE_SINGLESLOPE_gc /*  */),                                                   \
+	    INIT_REG16(TCA0.SINGLE.PER, 0x3e8 /* Top Value: 0x3e8 */),                                                 \
+	    INIT_REG(TCA0.SINGLE.CTRLA,                                                                                \
+	             TCA_SINGLE_CLKSEL_DIV1_gc /* System Clock */                                                      \
+	                 | 1 << TCA_SINGLE_ENABLE_bp /* Module Enable: enabled */)
+
 int8_t PWM_0_init(void);
 
+void PWM_0_register_callback(pwm_irq_cb_t f);
+
 void PWM_0_enable();
 
 void PWM_0_disable();
@@ -69,6 +134,16 @@ void PWM_0_load_duty_cycle_ch1(PWM_0_register_t duty_value);
 
 void PWM_0_load_duty_cycle_ch2(PWM_0_register_t duty_value);
 
+void PWM_0_load_all(const PWM_0_update_t *update);
+
+int8_t PWM_0_set_mode(TCA_SINGLE_WGMODE_t mode);
+
+int8_t PWM_0_set_frequency(uint32_t hz);
+
+void PWM_0_set_duty_permille(uint8_t channel, uint16_t permille);
+
+void PWM_0_clock_changed(uint32_t clk_hz);
+
 #ifdef __cplusplus
 }
 #endif
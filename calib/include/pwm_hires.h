@@ -0,0 +1,56 @@
+/*
+ * pwm_hires.h
+ */
+
+
+#ifndef PWM_HIRES_H_
+#define PWM_HIRES_H_
+
+#include <compiler.h>
+#include <pwm_basic.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*! Dithered high-resolution duty on one PWM_0 channel
+ *
+ * The compare value is kept with PWM_HIRES_FRAC_BITS extra fractional bits.
+ * A first-order sigma-delta in the TCA0 overflow callback adds the fraction
+ * to an error accumulator every period and loads CMPnBUF with the integer
+ * part, plus one on each accumulator carry. The average over 2^FRAC_BITS
+ * periods is the exact fractional value, the carrier frequency is unchanged.
+ * With PER = 1000 (~10 bits) and 6 fractional bits the effective resolution
+ * is ~16 bits; the dithering ripple sits at or above f_pwm / 2^FRAC_BITS,
+ * so fewer bits trade resolution for an easier output filter.
+ *
+ * ISR cost per period is ~90 cycles at PWM_0_INTERRUPT_CB_RATE 1 (~70 for
+ * callback entry and exit, ~20 for the accumulator and the 16-bit load),
+ * i.e. 9% of a 5 MHz CPU at a 5 kHz carrier. With a larger rate the average
+ * stays exact but every value is held for RATE periods.
+ *
+ * The channel is taken out of PWM_0_set_duty_permille(); register
+ * pwm_hires_clock_changed() after PWM_0_clock_changed() so a duty set as a
+ * fraction follows the new TOP after a calibration.
+ *
+ * Uses the PWM_0 overflow callback, so it cannot run with pwm_stream.
+ */
+
+//! Fractional bits of the compare value, 1 to 8
+#define PWM_HIRES_FRAC_BITS 6
+
+#if PWM_HIRES_FRAC_BITS < 1 || PWM_HIRES_FRAC_BITS > 8
+#error PWM_HIRES_FRAC_BITS must be 1 to 8
+#endif
+
+void pwm_hires_start(uint8_t channel);
+void pwm_hires_stop(void);
+void pwm_hires_set(uint32_t value);
+void pwm_hires_set_fraction(uint16_t duty);
+void pwm_hires_clock_changed(uint32_t clk_hz);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* PWM_HIRES_H_ */
@@ -0,0 +1,169 @@
+/*
+ * pwm_split.h
+ */
+
+
+#ifndef PWM_SPLIT_H_
+#define PWM_SPLIT_H_
+
+#include <compiler.h>
+#include <init_table.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*! TCA0 in split mode: two 8-bit down-counters, six 8-bit PWM channels.
+ *
+ * Channel  Compare  Default pin  Alternate pin (PORTMUX.CTRLC)
+ *   0      LCMP0    PB0          PB3 (TCA00)
+ *   1      LCMP1    PB1          PB4 (TCA01)
+ *   2      LCMP2    PB2          PB5 (TCA02)
+ *   3      HCMP0    PA3          PC3 (TCA03)
+ *   4      HCMP1    PA4          PC4 (TCA04)
+ *   5      HCMP2    PA5          PC5 (TCA05)
+ *
+ * TCA0 is shared with PWM_0 (single mode): PWM_SPLIT_0_init() resets the
+ * timer, so only one of the two drivers can be active.
+ *
+ * Duty writes are single 8-bit stores with no TEMP register, so the inline
+ * loaders below are 2 cycles / 3 words each and need no critical section.
+ * PWM_0_load_duty_cycle_chN() costs ~12 cycles (call, 16-bit store, ret)
+ * and must not race another 16-bit TCA0 access.
+ */
+
+//! Channels driven by the split PWM, bit n = channel n
+#define PWM_SPLIT_0_CHANNELS 0x3F
+//! Alternate pin selection written to PORTMUX.CTRLC, 0 = default pins
+#define PWM_SPLIT_0_PORTMUX 0x00
+//! Low and high counter period, PWM frequency = CLK_PER / (PER + 1)
+#define PWM_SPLIT_0_LPER 0xFF
+#define PWM_SPLIT_0_HPER 0xFF
+
+/** The datatype matching the bitwidth of a split PWM channel */
+typedef uint8_t PWM_SPLIT_0_register_t;
+
+/**
+ * \brief Split mode configuration, applied by PWM_SPLIT_0_init()
+ *
+ * The timer must be disabled and reset before SPLITM is set.
+ */
+#define PWM_SPLIT_0_INIT_TABLE                                                                                         \
+	INIT_REG(TCA0.SPLIT.CTRLA, 0 /* Disabled */), INIT_REG(TCA0.SPLIT.CTRLESET, TCA_SPLIT_CMD_RESET_gc),              \
+	    INIT_REG(TCA0.SPLIT.CTRLD, TCA_SPLIT_SPLITM_bm /* Split mode */),                                          \
+	    INIT_REG(PORTMUX.CTRLC, PWM_SPLIT_0_PORTMUX), INIT_REG(TCA0.SPLIT.LPER, PWM_SPLIT_0_LPER),                 \
+	    INIT_REG(TCA0.SPLIT.HPER, PWM_SPLIT_0_HPER), INIT_REG(TCA0.SPLIT.LCMP0, 0), INIT_REG(TCA0.SPLIT.LCMP1, 0), \
+	    INIT_REG(TCA0.SPLIT.LCMP2, 0), INIT_REG(TCA0.SPLIT.HCMP0, 0), INIT_REG(TCA0.SPLIT.HCMP1, 0),               \
+	    INIT_REG(TCA0.SPLIT.HCMP2, 0),                                                                             \
+	    INIT_REG(TCA0.SPLIT.CTRLB, (PWM_SPLIT_0_CHANNELS & 0x07) | (PWM_SPLIT_0_CHANNELS & 0x38) << 1),            \
+	    INIT_REG(TCA0.SPLIT.CTRLA,                                                                                 \
+	             TCA_SPLIT_CLKSEL_DIV1_gc /* System Clock */                                                       \
+	                 | 1 << TCA_SPLIT_ENABLE_bp /* Module Enable: enabled */)
+
+int8_t PWM_SPLIT_0_init(void);
+
+/**
+ * \brief Enable PWM_SPLIT_0
+ */
+static inline void PWM_SPLIT_0_enable(void)
+{
+	TCA0.SPLIT.CTRLA |= TCA_SPLIT_ENABLE_bm;
+}
+
+/**
+ * \brief Disable PWM_SPLIT_0
+ */
+static inline void PWM_SPLIT_0_disable(void)
+{
+	TCA0.SPLIT.CTRLA &= ~TCA_SPLIT_ENABLE_bm;
+}
+
+/**
+ * \brief Enable PWM output on a channel
+ *
+ * \param[in] channel Channel 0 to 5, constant for the shortest code
+ */
+static inline void PWM_SPLIT_0_enable_output(const uint8_t channel)
+{
+	TCA0.SPLIT.CTRLB |= (channel < 3) ? (1 << channel) : (0x10 << (channel - 3));
+}
+
+/**
+ * \brief Disable PWM output on a channel
+ *
+ * \param[in] channel Channel 0 to 5, constant for the shortest code
+ */
+static inline void PWM_SPLIT_0_disable_output(const uint8_t channel)
+{
+	TCA0.SPLIT.CTRLB &= ~((channel < 3) ? (1 << channel) : (0x10 << (channel - 3)));
+}
+
+/**
+ * \brief Load the period of the low (channels 0-2) counter
+ */
+static inline void PWM_SPLIT_0_load_top_low(PWM_SPLIT_0_register_t top_value)
+{
+	TCA0.SPLIT.LPER = top_value;
+}
+
+/**
+ * \brief Load the period of the high (channels 3-5) counter
+ */
+static inline void PWM_SPLIT_0_load_top_high(PWM_SPLIT_0_register_t top_value)
+{
+	TCA0.SPLIT.HPER = top_value;
+}
+
+/**
+ * \brief Load duty cycle register of channel 0 (LCMP0)
+ */
+static inline void PWM_SPLIT_0_load_duty_cycle_ch0(PWM_SPLIT_0_register_t duty_value)
+{
+	TCA0.SPLIT.LCMP0 = duty_value;
+}
+
+/**
+ * \brief Load duty cycle register of channel 1 (LCMP1)
+ */
+static inline void PWM_SPLIT_0_load_duty_cycle_ch1(PWM_SPLIT_0_register_t duty_value)
+{
+	TCA0.SPLIT.LCMP1 = duty_value;
+}
+
+/**
+ * \brief Load duty cycle register of channel 2 (LCMP2)
+ */
+static inline void PWM_SPLIT_0_load_duty_cycle_ch2(PWM_SPLIT_0_register_t duty_value)
+{
+	TCA0.SPLIT.LCMP2 = duty_value;
+}
+
+/**
+ * \brief Load duty cycle register of channel 3 (HCMP0)
+ */
+static inline void PWM_SPLIT_0_load_duty_cycle_ch3(PWM_SPLIT_0_register_t duty_value)
+{
+	TCA0.SPLIT.HCMP0 = duty_value;
+}
+
+/**
+ * \brief Load duty cycle register of channel 4 (HCMP1)
+ */
+static inline void PWM_SPLIT_0_load_duty_cycle_ch4(PWM_SPLIT_0_register_t duty_value)
+{
+	TCA0.SPLIT.HCMP1 = duty_value;
+}
+
+/**
+ * \brief Load duty cycle register of channel 5 (HCMP2)
+ */
+static inline void PWM_SPLIT_0_load_duty_cycle_ch5(PWM_SPLIT_0_register_t duty_value)
+{
+	TCA0.SPLIT.HCMP2 = duty_value;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* PWM_SPLIT_H_ */
@@ -0,0 +1,45 @@
+/*
+ * pwm_stream.h
+ */
+
+
+#ifndef PWM_STREAM_H_
+#define PWM_STREAM_H_
+
+#include <compiler.h>
+#include <pwm_basic.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*! Waveform streaming on PWM_0
+ *
+ * The TCA0 overflow callback loads one sample per PWM period into CMPnBUF
+ * of the selected channel, so the duty changes exactly on period
+ * boundaries whatever the main loop is doing.
+ *
+ * Two buffers are played ping-pong. A slot belongs to the application
+ * until pwm_stream_submit() publishes it, and to the ISR until its last
+ * sample is loaded; slots are released in submission order.
+ * If no buffer is ready at a period boundary the last duty is held and
+ * pwm_stream_underruns is incremented.
+ *
+ * ISR cost per sample is ~110 cycles (callback entry, load, exit), so
+ * at 5 MHz the sample rate (= PWM frequency) should stay below ~20 kHz
+ * to leave half of the CPU to the application.
+ */
+
+//! Number of periods a sample was missing
+extern volatile uint16_t pwm_stream_underruns;
+
+void   pwm_stream_start(uint8_t channel);
+void   pwm_stream_stop(void);
+int8_t pwm_stream_submit(const PWM_0_register_t *samples, uint8_t len);
+uint8_t pwm_stream_free_slots(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* PWM_STREAM_H_ */
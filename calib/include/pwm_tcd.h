@@ -0,0 +1,64 @@
+/*
+ * pwm_tcd.h
+ */
+
+
+#ifndef PWM_TCD_H_
+#define PWM_TCD_H_
+
+#include <compiler.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*! Complementary PWM with dead time on TCD0, WOA = PA4, WOB = PA5
+ *
+ * TCD0 counts the 20MHz oscillator (OSC20M) directly, before the CLK_PER
+ * prescaler, so at 5 MHz CPU it still has 4x the resolution of TCA0.
+ * Its counter is 12 bits: 4.9 kHz to 10 MHz at PWM_TCD_0_CNTPRES DIV1.
+ *
+ * One ramp:  one counter cycle, WOA on for the duty, WOB on for the rest,
+ *            PWM_TCD_0 dead time between the two.
+ * Two ramp:  the counter runs ramp A then ramp B, each output owns one ramp
+ *            and the dead time is the start of each ramp.
+ *
+ * The compare registers sit in the asynchronous TCD clock domain: a
+ * synchronisation command takes a few TCD clocks and no new one may be
+ * issued until STATUS.CMDRDY. The setters below only compute a shadow copy
+ * and call PWM_TCD_0_flush(), which loads it and requests the update at
+ * the end of the TCD cycle (SYNCEOC) if the previous one is done. If not,
+ * the values stay pending and the next flush (from the main loop, or the
+ * next setter) sends the latest ones, so the CPU never waits for the sync.
+ */
+
+//! TCD0 counter prescaler, only taken over while the timer is disabled
+#define PWM_TCD_0_CNTPRES TCD_CNTPRES_DIV1_gc
+//! Max wait for STATUS.ENRDY in PWM_TCD_0_enable(), a few TCD clocks normally
+#define PWM_TCD_0_ENRDY_TIMEOUT_US 100
+
+int8_t  PWM_TCD_0_init(void);
+int8_t  PWM_TCD_0_enable(void);
+void    PWM_TCD_0_disable(void);
+int8_t  PWM_TCD_0_set_mode(TCD_WGMODE_t mode);
+int8_t  PWM_TCD_0_set_frequency(uint32_t hz);
+void    PWM_TCD_0_set_duty_permille(uint16_t permille);
+void    PWM_TCD_0_set_dead_time(uint16_t ns);
+void    PWM_TCD_0_clock_changed(uint32_t clk_hz);
+uint8_t PWM_TCD_0_flush(void);
+
+/**
+ * \brief Check if a compare update is still being synchronized
+ *
+ * \return Nonzero while TCD0 cannot take a new command
+ */
+static inline uint8_t PWM_TCD_0_update_pending(void)
+{
+	return !(TCD0.STATUS & TCD_CMDRDY_bm);
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* PWM_TCD_H_ */
@@ -30,13 +30,103 @@
 
 #include <compiler.h>
 #include <utils_assert.h>
+#include <init_table.h>
+#include <atomic.h>
 
 #ifdef __cplusplus
 extern "C" {
 #endif
 
+/**
+ * Width of the extended RTC time, 32 or 48 bits.
+ * RTC.CNT gives the low 16 bits, the overflow interrupt counts the rest.
+ * At 32.768 kHz 32 bits wrap after 36 hours, 48 bits after 272 years;
+ * 48 bits costs 64-bit arithmetic on every read and compare.
+ */
+#define RTC_0_TIME_BITS 32
+
+#if RTC_0_TIME_BITS == 48
+typedef uint64_t rtc_time_t;
+typedef int64_t  rtc_stime_t;
+typedef uint32_t RTC_0_ovf_t;
+#elif RTC_0_TIME_BITS == 32
+typedef uint32_t rtc_time_t;
+typedef int32_t  rtc_stime_t;
+typedef uint16_t RTC_0_ovf_t;
+#else
+#error RTC_0_TIME_BITS must be 32 or 48
+#endif
+
+/**
+ * A compare must be at least this many ticks ahead when it is set, to
+ * cover the CMP synchronization into the RTC clock domain.
+ */
+#define RTC_0_CMP_MIN_TICKS 3
+
+typedef void (*rtc_cb_t)(void);
+
+/** Upper bits of the extended time, incremented by the overflow interrupt */
+extern volatile RTC_0_ovf_t RTC_0_ovf_count;
+
+/** PIT callback, only called while the PIT interrupt is enabled */
+extern rtc_cb_t RTC_0_pit_cb;
+
+/**
+ * \brief RTC configuration, applied by RTC_0_init() and by system_init()
+ *
+ * The clock source is selected before the RTC is enabled. The calibration
+ * measures against this XOSC32K time base, so it must stay TOSC32K.
+ * PER is left at its reset value 0xFFFF, the overflow interrupt extends
+ * the count from there.
+ */
+#define RTC_0_INIT_TABLE                                                                                               \
+	INIT_REG(RTC.CLKSEL, RTC_CLKSEL_TOSC32K_gc /* 32.768kHz External Crystal Oscillator (XOSC32K) */),               \
+	    INIT_REG(RTC.CTRLA,                                                                                        \
+	             RTC_PRESCALER_DIV1_gc   /* 1 */                                                                   \
+	                 | 1 << RTC_RTCEN_bp /* Enable: enabled */                                                     \
+	                 | 0 << RTC_RUNSTDBY_bp /* Run In Standby: disabled */),                                       \
+	    INIT_REG(RTC.INTCTRL, 1 << RTC_OVF_bp /* Overflow Interrupt enable: enabled */)
+
 int8_t RTC_0_init();
 
+int8_t RTC_0_set_compare(rtc_time_t deadline, rtc_cb_t cb);
+
+void RTC_0_cancel_compare(void);
+
+void RTC_0_compare_isr(void);
+
+void RTC_0_pit_start(RTC_PERIOD_t period, rtc_cb_t cb);
+
+void RTC_0_pit_stop(void);
+
+/**
+ * \brief Read the extended RTC time
+ *
+ * If the counter wrapped but the overflow interrupt has not run yet (we
+ * are in a critical section or a higher priority ISR), OVF is still set:
+ * the missing overflow is added and CNT is read again, since the first
+ * read may be from before the wrap. About 20 cycles with 32 bits.
+ * Safe from any context, including RTC callbacks.
+ *
+ * \return Ticks of 1/32768 s since RTC_0_init()
+ */
+static inline rtc_time_t RTC_0_now(void)
+{
+	rtc_time_t hi;
+	uint16_t   cnt;
+
+	ENTER_CRITICAL(R);
+	hi  = RTC_0_ovf_count;
+	cnt = RTC.CNT;
+	if (RTC.INTFLAGS & RTC_OVF_bm) {
+		hi++;
+		cnt = RTC.CNT;
+	}
+	EXIT_CRITICAL(R);
+
+	return hi << 16 | cnt;
+}
+
 #ifdef __cplusplus
 }
 #endif
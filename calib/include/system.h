@@ -40,30 +40,27 @@
 
 #include "ccp.h"
 #include "port.h"
+#include "init_table.h"
 
 #ifdef __cplusplus
 extern "C" {
 #endif
 
+/* Set all pins to low power mode. PINnCTRL are zero after reset, so the
+ * pull-up is stored directly instead of read-modify-write */
+#define MCU_INIT_TABLE                                                                                                 \
+	INIT_FILL(PORTA.PIN0CTRL, 1 << PORT_PULLUPEN_bp, 8), INIT_FILL(PORTB.PIN0CTRL, 1 << PORT_PULLUPEN_bp, 8),         \
+	    INIT_FILL(PORTC.PIN0CTRL, 1 << PORT_PULLUPEN_bp, 8)
+
 void mcu_init(void)
 {
 	/* On AVR devices all peripherals are enable from power on reset, this
 	 * disables all peripherals to save power. Driver shall enable
 	 * peripheral if used */
 
-	/* Set all pins to low power mode */
-
-	for (uint8_t i = 0; i < 8; i++) {
-		*((uint8_t *)&PORTA + 0x10 + i) |= 1 << PORT_PULLUPEN_bp;
-	}
-
-	for (uint8_t i = 0; i < 8; i++) {
-		*((uint8_t *)&PORTB + 0x10 + i) |= 1 << PORT_PULLUPEN_bp;
-	}
+	static const init_table_entry_t init[] = {MCU_INIT_TABLE};
 
-	for (uint8_t i = 0; i < 8; i++) {
-		*((uint8_t *)&PORTC + 0x10 + i) |= 1 << PORT_PULLUPEN_bp;
-	}
+	init_table_apply(init, ARRAY_SIZE(init));
 }
 #ifdef __cplusplus
 }
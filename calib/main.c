@@ -1,23 +1,25 @@
 #include <atmel_start.h>
 #include <avr/cpufunc.h>
 #include "calibRC.h"
-#include <util/delay.h>
-
-signed char result = 0;
+#include "scheduler.h"
+#include "recal_policy.h"
 
 int main(void)
 {
 	/* Initializes MCU, drivers and middleware */
 	atmel_start_init();
+	/* Application init goes here, it overlaps the crystal start-up */
+	CalibAddClockCallback(PWM_0_clock_changed);
+	PWM_0_set_frequency(5000);
+	PWM_0_set_duty_permille(1, 500);					// Runs all the time: the scheduler only sleeps in IDLE
 	InitCalibRc();
-	_delay_ms(10);
 	//_NOP();
 	//CalibInternalRc();
 	//_NOP();
 	/* Replace with your application code */
-	while (1) {		
-		result = CalibInternalRc();
-		_NOP();
-		_delay_ms(5000);		
-	}
+	soft_timer_init();
+	scheduler_init();
+	recal_policy_start();								// Calibrates now, then when conditions change
+	ENABLE_INTERRUPTS();								// Required: soft timers, VLM and PWM callbacks, after the first calibration
+	scheduler_run();
 }
@@ -0,0 +1,67 @@
+/*
+ * profile.c
+ */
+
+#include "profile.h"
+
+#if PROFILE_ENABLE
+
+profile_stat_t profile_stats[PROFILE_REGION_COUNT];
+uint16_t profile_overhead;
+
+/*! \brief Start the profiling time base
+*
+* TCB0 runs in periodic interrupt mode with TOP = 0xFFFF and the interrupt
+* disabled, so CNT is a free-running 16-bit cycle counter on CLK_PER.
+* Must be called before the first PROFILE_BEGIN().
+*/
+void profile_init(void)
+{
+	uint16_t t;
+
+	TCB0.CCMP = 0xFFFF;
+	TCB0.CTRLB = TCB_CNTMODE_INT_gc;
+	TCB0.CTRLA = TCB_CLKSEL_CLKDIV1_gc | 1 << TCB_ENABLE_bp;
+
+	profile_reset();
+
+	// Measure an empty region once so it can be removed from every sample
+	profile_overhead = 0;
+	PROFILE_BEGIN(0);
+	t = TCB0.CNT;
+	profile_overhead = t - profile_stats[0].start;
+}
+
+/*! \brief Clear the statistics of all regions
+*/
+void profile_reset(void)
+{
+	for (uint8_t i = 0; i < PROFILE_REGION_COUNT; i++) {
+		profile_stats[i].count = 0;
+		profile_stats[i].min = 0xFFFF;
+		profile_stats[i].max = 0;
+		profile_stats[i].total = 0;
+	}
+}
+
+/*! \brief Close a region and fold the sample into its statistics
+*
+* \param region One of profile_region
+* \param stop   TCB0.CNT read at the end of the region (done by PROFILE_END())
+*/
+void profile_end(uint8_t region, uint16_t stop)
+{
+	profile_stat_t *s = &profile_stats[region];
+	uint16_t cycles = stop - s->start - profile_overhead;		// Modulo 2^16, wrap is harmless
+
+	if (cycles < s->min) {
+		s->min = cycles;
+	}
+	if (cycles > s->max) {
+		s->max = cycles;
+	}
+	s->total += cycles;
+	s->count++;
+}
+
+#endif /* PROFILE_ENABLE */
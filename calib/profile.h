@@ -0,0 +1,71 @@
+/*
+ * profile.h
+ */
+
+
+#ifndef PROFILE_H_
+#define PROFILE_H_
+
+#include <compiler.h>
+
+/*! Cycle profiler, backed by TCB0 free-running on CLK_PER.
+ * Set to 1 to build it in. With 0 every PROFILE_* macro expands to nothing,
+ * TCB0 is left untouched and no RAM or flash is used.
+ */
+#ifndef PROFILE_ENABLE
+#define PROFILE_ENABLE 0
+#endif
+
+/*! Profiled regions, one statistics slot each */
+enum profile_region {
+	PROFILE_SYSTEM_INIT,
+	PROFILE_INIT_TABLE,
+	PROFILE_CPUINT_INIT,
+	PROFILE_INIT_CALIB,
+	PROFILE_COUNTER,
+	PROFILE_NEIGHBOR_SEARCH,
+	PROFILE_TIMER_START,
+	PROFILE_TIMER_CANCEL,
+	PROFILE_TIMER_PROCESS,		// Taking the expired timers, without their callbacks
+	PROFILE_TIMER_REARM,		// Finding and programming the next deadline
+	PROFILE_CLOCK_SWITCH,
+	PROFILE_CLOCK_NOTIFY,
+	PROFILE_REGION_COUNT
+};
+
+#if PROFILE_ENABLE
+
+/*! Statistics of one region, in CLK_PER cycles.
+ * A single region must be shorter than 65536 cycles (13 ms at 5 MHz), so
+ * waits such as the crystal start-up are timed apart (see xtalStartupMs).
+ * The table is plain RAM so it can be read with the debugger (UPDI) watch window.
+ */
+typedef struct {
+	uint16_t start;			// TCB0.CNT when the region was entered
+	uint16_t count;			// Number of completed samples
+	uint16_t min;
+	uint16_t max;
+	uint32_t total;
+} profile_stat_t;
+
+extern profile_stat_t profile_stats[PROFILE_REGION_COUNT];
+//! Cycles spent by an empty BEGIN/END pair, subtracted from every sample
+extern uint16_t profile_overhead;
+
+void profile_init(void);
+void profile_reset(void);
+void profile_end(uint8_t region, uint16_t stop);
+
+#define PROFILE_INIT()			profile_init()
+#define PROFILE_BEGIN(region)	(profile_stats[(region)].start = TCB0.CNT)
+#define PROFILE_END(region)		profile_end((region), TCB0.CNT)
+
+#else
+
+#define PROFILE_INIT()
+#define PROFILE_BEGIN(region)
+#define PROFILE_END(region)
+
+#endif /* PROFILE_ENABLE */
+
+#endif /* PROFILE_H_ */
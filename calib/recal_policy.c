@@ -0,0 +1,171 @@
+/*
+ * recal_policy.c
+ */
+
+#include "recal_policy.h"
+#include "calibRC.h"
+#include "soft_timer.h"
+#include "clock_target.h"
+
+recal_stats_t recal_stats;
+
+static soft_timer_t       recal_timer;
+static rtc_time_t         recal_last;      // RTC time of the last calibration
+static uint8_t            recal_verify_cnt;
+static volatile uint8_t   recal_vdd_changed; // Set by the VLM interrupt
+
+/*! \brief VLM callback, runs in the BOD interrupt
+*
+* Only flags the fall and posts the check timer: probing the band takes
+* ~30 us of delays and a band switch notifies the drivers, both are left to
+* recal_policy_check(), which runs as soon as the main loop is back. The
+* VLM is stopped until the check watches the new band.
+*/
+static void recal_vlm_cb(void)
+{
+	BOD_vlm_disable();
+	recal_vdd_changed = 1;
+	soft_timer_post(&recal_timer);
+}
+
+/*! \brief Follow the supply band, from a check
+*
+* Switches to the stored trim code of the new band if there is one.
+*
+* \return 1 if the band needs a calibration
+*/
+static uint8_t recal_follow_band(void)
+{
+	uint8_t band = BOD_vlm_band();
+
+	if (recal_vdd_changed) {
+		recal_vdd_changed = 0;
+		recal_stats.vlm_falls++;
+	}
+	BOD_vlm_watch_band(band);
+	if (band == recal_stats.vdd_band) {
+		return 0;
+	}
+	recal_stats.vdd_band = band;
+	if (CalibSetVddBand(&calibDefault, band)) {
+		recal_stats.band_switches++;
+		return 0;
+	}
+	return 1;
+}
+
+/*! \brief Read the internal temperature sensor
+*
+* One conversion against the 1.1V reference, converted with the factory
+* gain and offset from the signature row. The ADC is disabled afterwards.
+*
+* \return Temperature in K
+*/
+uint16_t recal_read_temperature(void)
+{
+	int8_t   offset = SIGROW.TEMPSENSE1;
+	uint8_t  gain   = SIGROW.TEMPSENSE0;
+	uint32_t temp;
+
+	VREF.CTRLA    = (VREF.CTRLA & ~VREF_ADC0REFSEL_gm) | VREF_ADC0REFSEL_1V1_gc;
+	ADC0.CTRLB    = ADC_SAMPNUM_ACC1_gc;
+	ADC0.CTRLC    = ADC_SAMPCAP_bm | ADC_REFSEL_INTREF_gc | ADC_PRESC_DIV16_gc;
+	ADC0.CTRLD    = ADC_INITDLY_DLY32_gc; /* >= 32 us for the sensor */
+	ADC0.SAMPCTRL = 31;
+	ADC0.MUXPOS   = ADC_MUXPOS_TEMPSENSE_gc;
+	ADC0.CTRLA    = ADC_ENABLE_bm;
+	ADC0.COMMAND  = ADC_STCONV_bm;
+	while (!(ADC0.INTFLAGS & ADC_RESRDY_bm)) {
+	}
+	temp       = ADC0.RES; /* Clears RESRDY */
+	ADC0.CTRLA = 0;
+
+	temp -= offset;
+	temp *= gain;
+	temp += 0x80;
+	return temp >> 8;
+}
+
+/*! \brief Calibrate now and take the new reference point
+*/
+static void recal_run(uint8_t reason)
+{
+	recal_vdd_changed    = 0;
+	recal_stats.vdd_band = BOD_vlm_band();
+	BOD_vlm_watch_band(recal_stats.vdd_band);
+	CalibSetVddBand(&calibDefault, recal_stats.vdd_band); /* Closest known start for the search */
+	recal_stats.result = CalibInternalRc();
+	recal_stats.recals[reason]++;
+	recal_stats.temp_k   = recal_read_temperature();
+	recal_stats.error_pm = CalibVerify(&calibDefault, RECAL_VERIFY_TICKS);
+	recal_stats.drift_pm = 0;
+	recal_last           = RTC_0_now();
+	recal_verify_cnt     = 0;
+}
+
+/*! \brief Soft timer callback
+*/
+static void recal_timer_cb(soft_timer_t *timer)
+{
+	(void)timer;
+	recal_policy_check();
+}
+
+/*! \brief Calibrate once and start watching the triggers
+*
+* Needs the soft timers and the RTC running, and InitCalibRc() done.
+*/
+void recal_policy_start(void)
+{
+	BOD_vlm_enable(BOD_VLMLVL_5ABOVE_gc, BOD_VLMCFG_BELOW_gc, recal_vlm_cb);
+	recal_run(RECAL_REASON_START);
+	soft_timer_start(&recal_timer, SOFT_TIMER_MS(RECAL_CHECK_INTERVAL_MS), SOFT_TIMER_MS(RECAL_CHECK_INTERVAL_MS),
+	                 recal_timer_cb);
+}
+
+/*! \brief Run the cheap checks, calibrate if one of them fires
+*
+* Checked from the cheapest, the first trigger found is the reason.
+* Nothing is done while a clock target is selected.
+*/
+void recal_policy_check(void)
+{
+	uint16_t temp;
+	int16_t  diff;
+
+	if (clock_target_current() >= 0) {
+		return; /* OSCCALR belongs to the selected clock target, not calibDefault */
+	}
+	recal_stats.checks++;
+
+	if (recal_follow_band()) { /* A rise in supply is only seen here */
+		recal_run(RECAL_REASON_VDD);
+		return;
+	}
+	if ((rtc_time_t)(RTC_0_now() - recal_last) >= (rtc_time_t)RECAL_MAX_INTERVAL_S * 32768UL) {
+		recal_run(RECAL_REASON_TIME);
+		return;
+	}
+
+	temp = recal_read_temperature();
+	diff = temp - recal_stats.temp_k;
+	if (diff < 0) {
+		diff = -diff;
+	}
+	if (diff >= RECAL_TEMP_DELTA_K) {
+		recal_run(RECAL_REASON_TEMP);
+		return;
+	}
+
+	if (++recal_verify_cnt >= RECAL_VERIFY_EVERY) {
+		recal_verify_cnt     = 0;
+		recal_stats.drift_pm = CalibVerify(&calibDefault, RECAL_VERIFY_TICKS) - recal_stats.error_pm;
+		diff                 = recal_stats.drift_pm;
+		if (diff < 0) {
+			diff = -diff;
+		}
+		if (diff > RECAL_VERIFY_PERMILLE) {
+			recal_run(RECAL_REASON_ERROR);
+		}
+	}
+}
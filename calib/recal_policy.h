@@ -0,0 +1,81 @@
+/*
+ * recal_policy.h
+ */
+
+
+#ifndef RECAL_POLICY_H_
+#define RECAL_POLICY_H_
+
+#include <compiler.h>
+#include <bod.h>
+
+/*! Decides when the oscillator needs a new calibration.
+ *
+ * Every RECAL_CHECK_INTERVAL_MS a soft timer runs the cheap checks below.
+ * A full calibration (~20 ms of busy counting) only runs when one of them
+ * fires; the reason is counted in recal_stats.
+ *
+ * - Temperature: the ADC temperature sensor moved RECAL_TEMP_DELTA_K from
+ *   the last calibration (~100 us, every check).
+ * - VDD: the supply moved to a band (see BOD_VLM_BANDS) that has no trim
+ *   code yet. The band is probed at every check, and a fall seen by the
+ *   VLM interrupt posts a check at once (soft_timer_post()), so the switch
+ *   does not wait for the next period. A band with a stored code is
+ *   switched to without a search and band 0 restores the factory value
+ *   (needs the BOD enabled by fuse). Nothing runs from the interrupt, so
+ *   the drivers and the measurements are never disturbed by a switch.
+ * - Time: RECAL_MAX_INTERVAL_S elapsed since the last calibration.
+ * - Error: a RECAL_VERIFY_TICKS window measured a drift of more than
+ *   RECAL_VERIFY_PERMILLE from the error seen just after the last
+ *   calibration (~1 ms, every RECAL_VERIFY_EVERY checks).
+ *
+ * The checks pause while a clock_target is selected: its code must not
+ * be overwritten with the one of calibDefault.
+ *
+ * With the defaults and stable conditions this is ~1 ms of counting per
+ * minute plus one calibration per hour, against 20 ms every 5 s before:
+ * about 200x less CPU time spent on calibration.
+ */
+
+//! Period of the cheap checks
+#define RECAL_CHECK_INTERVAL_MS 10000
+//! Longest time between two calibrations
+#define RECAL_MAX_INTERVAL_S 3600
+//! Temperature change that triggers a calibration, in K
+#define RECAL_TEMP_DELTA_K 5
+//! Run the verification window every n checks
+#define RECAL_VERIFY_EVERY 6
+//! Verification window, in 32kHz ticks
+#define RECAL_VERIFY_TICKS 32
+//! Drift of the verified error that triggers a calibration, in 1/1000
+#define RECAL_VERIFY_PERMILLE 5
+
+//! Why a calibration was run
+enum recal_reason {
+	RECAL_REASON_START,
+	RECAL_REASON_TIME,
+	RECAL_REASON_TEMP,
+	RECAL_REASON_VDD,
+	RECAL_REASON_ERROR,
+	RECAL_REASON_COUNT
+};
+
+typedef struct {
+	uint16_t checks;                     // Number of checks run
+	uint16_t recals[RECAL_REASON_COUNT]; // Calibrations per reason
+	uint16_t temp_k;                     // Temperature of the last calibration
+	int16_t  error_pm;                   // Verified error just after it, 1/1000
+	int16_t  drift_pm;                   // Last verified drift from error_pm
+	int8_t   result;                     // CalibInternalRc() result of the last calibration
+	uint8_t  vdd_band;                   // Current supply band
+	uint16_t band_switches;              // Band changes served by a stored code
+	uint16_t vlm_falls;                  // Checks that followed a VLM interrupt
+} recal_stats_t;
+
+extern recal_stats_t recal_stats;
+
+void recal_policy_start(void);
+void recal_policy_check(void);
+uint16_t recal_read_temperature(void);
+
+#endif /* RECAL_POLICY_H_ */
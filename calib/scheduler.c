@@ -0,0 +1,144 @@
+/*
+ * scheduler.c
+ */
+
+#include "scheduler.h"
+#include "device_traits.h"
+#include <atmel_start.h>
+#include <atomic.h>
+#include <avr/sleep.h>
+
+scheduler_stats_t scheduler_stats;
+
+//! Number of holders of each lock, SCHEDULER_IDLE and SCHEDULER_STANDBY
+static uint8_t scheduler_locks[SCHEDULER_POWERDOWN];
+
+static const SLPCTRL_SMODE_t scheduler_smode[SCHEDULER_MODE_COUNT] = {
+	SLPCTRL_SMODE_IDLE_gc, SLPCTRL_SMODE_STDBY_gc, SLPCTRL_SMODE_PDOWN_gc};
+
+/*! \brief Clear the statistics and the locks
+*/
+void scheduler_init(void)
+{
+	uint8_t i;
+
+	for (i = 0; i < SCHEDULER_MODE_COUNT; i++) {
+		scheduler_stats.ticks[i] = 0;
+		scheduler_stats.count[i] = 0;
+	}
+	scheduler_stats.late_max      = 0;
+	scheduler_stats.late_total    = 0;
+	scheduler_stats.timed_wakeups = 0;
+	scheduler_locks[SCHEDULER_IDLE]    = 0;
+	scheduler_locks[SCHEDULER_STANDBY] = 0;
+}
+
+/*! \brief Forbid the sleep modes deeper than \a mode
+*
+* For a peripheral the scheduler does not know about, e.g. a USART
+* transfer: lock SCHEDULER_IDLE while it needs CLK_PER.
+* Locks nest, each lock needs its unlock.
+*
+* \param mode SCHEDULER_IDLE or SCHEDULER_STANDBY
+*/
+void scheduler_lock(uint8_t mode)
+{
+	if (mode < SCHEDULER_POWERDOWN) {
+		scheduler_locks[mode]++;
+	}
+}
+
+/*! \brief Release a lock taken with scheduler_lock()
+*/
+void scheduler_unlock(uint8_t mode)
+{
+	if (mode < SCHEDULER_POWERDOWN && scheduler_locks[mode]) {
+		scheduler_locks[mode]--;
+	}
+}
+
+/*! \brief The deepest sleep mode allowed now
+*
+* \param timed    Nonzero if a timer runs
+* \param deadline Its expiry, see soft_timer_next()
+*
+* \return One of scheduler_mode
+*/
+uint8_t scheduler_select_mode(uint8_t timed, rtc_time_t deadline)
+{
+	if (scheduler_locks[SCHEDULER_IDLE] || (TCA0.SINGLE.CTRLA & TCA_SINGLE_ENABLE_bm)) {
+		return SCHEDULER_IDLE;
+	}
+#if DEVICE_HAS_TCD
+	if (TCD0.CTRLA & TCD_ENABLE_bm) {
+		return SCHEDULER_IDLE;
+	}
+#endif
+	if (timed) {
+		if ((rtc_stime_t)(deadline - RTC_0_now()) < SCHEDULER_STANDBY_MIN_TICKS) {
+			return SCHEDULER_IDLE;
+		}
+		return SCHEDULER_STANDBY;
+	}
+	return scheduler_locks[SCHEDULER_STANDBY] ? SCHEDULER_STANDBY : SCHEDULER_POWERDOWN;
+}
+
+/*! \brief Run the expired timers, or sleep until the next interrupt
+*
+* The last check for expired timers is done with interrupts disabled and
+* "sei; sleep" cannot be interrupted in between, so an expiry is never
+* slept through.
+*/
+void scheduler_step(void)
+{
+	rtc_time_t deadline = 0;
+	rtc_time_t before, after;
+	uint8_t    timed, mode;
+
+	if (soft_timer_process()) {
+		return;
+	}
+
+	timed = soft_timer_next(&deadline);
+	mode  = scheduler_select_mode(timed, deadline);
+	if (mode == SCHEDULER_STANDBY && !(RTC.CTRLA & RTC_RUNSTDBY_bm)) {
+		while (RTC.STATUS & RTC_CTRLABUSY_bm) {
+		}
+		RTC.CTRLA |= RTC_RUNSTDBY_bm;
+	}
+
+	before = RTC_0_now();
+	DISABLE_INTERRUPTS();
+	if (!soft_timer_pending()) {
+		SLPCTRL.CTRLA = scheduler_smode[mode] | SLPCTRL_SEN_bm;
+		ENABLE_INTERRUPTS();
+		sleep_cpu();
+		SLPCTRL.CTRLA &= ~SLPCTRL_SEN_bm;
+	}
+	ENABLE_INTERRUPTS();
+	after = RTC_0_now();
+
+	scheduler_stats.ticks[mode] += after - before;
+	scheduler_stats.count[mode]++;
+	if (timed && soft_timer_pending()) {
+		rtc_stime_t late = after - deadline;
+
+		if (late < 0) {
+			late = 0;
+		}
+		if (late > scheduler_stats.late_max) {
+			scheduler_stats.late_max = late;
+		}
+		scheduler_stats.late_total += late;
+		scheduler_stats.timed_wakeups++;
+	}
+}
+
+/*! \brief The application main loop, never returns
+*/
+void scheduler_run(void)
+{
+	while (1) {
+		scheduler_step();
+	}
+}
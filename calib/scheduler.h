@@ -0,0 +1,69 @@
+/*
+ * scheduler.h
+ */
+
+
+#ifndef SCHEDULER_H_
+#define SCHEDULER_H_
+
+#include <compiler.h>
+#include "soft_timer.h"
+
+/*! Tickless run loop: runs the soft_timer callbacks and sleeps in between.
+ *
+ * There is no periodic tick. Before each sleep the next soft timer
+ * deadline is taken from the wheel (it is already programmed in RTC.CMP)
+ * and the deepest sleep mode the running peripherals allow is chosen:
+ *
+ * IDLE       TCA0 or TCD0 enabled (they stop in standby), a
+ *            SCHEDULER_IDLE lock, or a deadline closer than
+ *            SCHEDULER_STANDBY_MIN_TICKS.
+ * STANDBY    a timer is running or a SCHEDULER_STANDBY lock is held.
+ *            RTC_RUNSTDBY is set the first time, so the RTC keeps
+ *            counting and its compare wakes the CPU.
+ * POWERDOWN  nothing to wait for: only pins, BOD and the PIT wake up.
+ *            The RTC counter stops, so RTC_0_now() does not advance.
+ *
+ * Limit: TCA0 and TCD0 stop in standby, so while PWM_0 or PWM_TCD_0 is
+ * enabled only IDLE is used. main() keeps PWM_0 running all the time, so
+ * the application as shipped never enters STANDBY or POWERDOWN; only an
+ * application that stops its PWM between uses does, as
+ * scheduler_benchmark() shows.
+ *
+ * Waking from standby restarts OSC20M (~12 us) before the RTC interrupt
+ * runs; with the 30.5 us RTC tick this keeps the callbacks within one
+ * tick of their deadline. Deadlines closer than the break-even time are
+ * waited in IDLE instead. The lateness actually seen is kept in
+ * scheduler_stats, with the time spent in each mode.
+ */
+
+//! Sleep modes, from the shallowest
+enum scheduler_mode {
+	SCHEDULER_IDLE,
+	SCHEDULER_STANDBY,
+	SCHEDULER_POWERDOWN,
+	SCHEDULER_MODE_COUNT
+};
+
+//! A deadline closer than this many RTC ticks is waited in IDLE
+#define SCHEDULER_STANDBY_MIN_TICKS 2
+
+/*! Sleep statistics, read them with the debugger or from a timer callback */
+typedef struct {
+	rtc_time_t ticks[SCHEDULER_MODE_COUNT]; // RTC ticks asleep per mode, stays 0 for POWERDOWN
+	uint16_t   count[SCHEDULER_MODE_COUNT]; // Number of sleeps per mode
+	uint16_t   late_max;                    // Worst wake-up after the timer deadline, RTC ticks
+	rtc_time_t late_total;                  // Sum of the lateness over timed wake-ups
+	uint16_t   timed_wakeups;               // Wake-ups by the RTC compare
+} scheduler_stats_t;
+
+extern scheduler_stats_t scheduler_stats;
+
+void scheduler_init(void);
+void scheduler_lock(uint8_t mode);
+void scheduler_unlock(uint8_t mode);
+uint8_t scheduler_select_mode(uint8_t timed, rtc_time_t deadline);
+void scheduler_step(void);
+void scheduler_run(void);
+
+#endif /* SCHEDULER_H_ */
@@ -0,0 +1,308 @@
+/*
+ * soft_timer.c
+ */
+
+#include "soft_timer.h"
+#include "profile.h"
+#include <atomic.h>
+
+#define SLOT_OF(t) ((uint8_t)((t) >> SOFT_TIMER_SLOT_SHIFT) & (SOFT_TIMER_SLOTS - 1))
+
+static soft_timer_t *soft_timer_wheel[SOFT_TIMER_SLOTS];
+//! Bit n set while slot n is not empty
+static uint8_t soft_timer_busy[SOFT_TIMER_SLOTS / 8];
+//! Deadline programmed in RTC.CMP, valid while soft_timer_armed
+static rtc_time_t soft_timer_deadline;
+static uint8_t    soft_timer_armed;
+//! Set by the RTC compare interrupt
+static volatile uint8_t soft_timer_expired;
+//! No running timer expires before it: the expiries up to it were taken
+static rtc_time_t soft_timer_scanned;
+//! Timers given by soft_timer_post(), most recent first
+static soft_timer_t *volatile soft_timer_posted;
+
+/*! \brief RTC compare callback, runs in the RTC interrupt
+*/
+static void soft_timer_isr(void)
+{
+	soft_timer_expired = 1;
+}
+
+/*! \brief Insert a timer at the head of a list
+*/
+static void soft_timer_push(soft_timer_t **head, soft_timer_t *timer)
+{
+	timer->next = *head;
+	if (timer->next) {
+		timer->next->pprev = &timer->next;
+	}
+	timer->pprev = head;
+	*head        = timer;
+}
+
+/*! \brief Link a timer in the slot of its expiry
+*/
+static void soft_timer_link(soft_timer_t *timer)
+{
+	uint8_t slot = SLOT_OF(timer->expires);
+
+	soft_timer_push(&soft_timer_wheel[slot], timer);
+	soft_timer_busy[slot >> 3] |= 1 << (slot & 7);
+}
+
+/*! \brief Unlink a running timer, from its slot or from the expired list
+*/
+static void soft_timer_unlink(soft_timer_t *timer)
+{
+	uint8_t slot;
+
+	*timer->pprev = timer->next;
+	if (timer->next) {
+		timer->next->pprev = timer->pprev;
+	}
+	timer->pprev = NULL;
+
+	slot = SLOT_OF(timer->expires);
+	if (soft_timer_wheel[slot] == NULL) {
+		soft_timer_busy[slot >> 3] &= ~(1 << (slot & 7));
+	}
+}
+
+/*! \brief Program RTC.CMP with a deadline
+*
+* If the deadline is too close for the compare, the expiry is flagged at once.
+*/
+static void soft_timer_arm(rtc_time_t deadline)
+{
+	soft_timer_deadline = deadline;
+	soft_timer_armed    = 1;
+	if (RTC_0_set_compare(deadline, soft_timer_isr) < 0) {
+		soft_timer_expired = 1;
+	}
+}
+
+/*! \brief Find the earliest expiry
+*
+* Slots are visited in time order from the one of soft_timer_scanned, not
+* from the current one: a timer that came due while the callbacks ran can
+* be in a slot already behind the current time. In the first busy
+* slot only timers of the current round count; if it only holds later
+* rounds the search goes on, and after a whole turn the earliest timer
+* seen is the answer.
+*
+* \param when Earliest expiry, written if a timer runs
+*
+* \return 1 if a timer runs, 0 if none
+*/
+uint8_t soft_timer_next(rtc_time_t *when)
+{
+	rtc_time_t    slot_start = soft_timer_scanned & ~(rtc_time_t)((1 << SOFT_TIMER_SLOT_SHIFT) - 1);
+	rtc_time_t    best       = 0;
+	uint8_t       found      = 0;
+	uint16_t      n;
+	uint8_t       slot;
+	soft_timer_t *t;
+
+	for (n = 0; n < SOFT_TIMER_SLOTS; n++, slot_start += 1 << SOFT_TIMER_SLOT_SHIFT) {
+		slot = SLOT_OF(slot_start);
+		if (soft_timer_busy[slot >> 3] == 0) {
+			/* Skip the rest of an empty bitmap byte */
+			n += 7 - (slot & 7);
+			slot_start += (rtc_time_t)(7 - (slot & 7)) << SOFT_TIMER_SLOT_SHIFT;
+			continue;
+		}
+		if (!(soft_timer_busy[slot >> 3] & (1 << (slot & 7)))) {
+			continue;
+		}
+		for (t = soft_timer_wheel[slot]; t; t = t->next) {
+			if (!found || (rtc_stime_t)(t->expires - best) < 0) {
+				best  = t->expires;
+				found = 1;
+			}
+		}
+		if ((rtc_stime_t)(best - slot_start) < (1 << SOFT_TIMER_SLOT_SHIFT)) {
+			break; /* Due in this round, nothing later can be earlier */
+		}
+	}
+	if (found) {
+		*when = best;
+	}
+	return found;
+}
+
+/*! \brief Reprogram RTC.CMP with the earliest expiry, or disarm it
+*/
+static void soft_timer_rearm(void)
+{
+	rtc_time_t next;
+
+	if (soft_timer_next(&next)) {
+		soft_timer_arm(next);
+	} else {
+		soft_timer_armed = 0;
+		RTC_0_cancel_compare();
+	}
+}
+
+/*! \brief Take over the RTC compare channel, no timer is running
+*/
+void soft_timer_init(void)
+{
+	soft_timer_t *t;
+	uint8_t       i;
+
+	RTC_0_cancel_compare();
+	for (i = 0; i < SOFT_TIMER_SLOTS; i++) {
+		soft_timer_wheel[i] = NULL;
+	}
+	for (i = 0; i < SOFT_TIMER_SLOTS / 8; i++) {
+		soft_timer_busy[i] = 0;
+	}
+	soft_timer_armed   = 0;
+	soft_timer_expired = 0;
+	soft_timer_scanned = RTC_0_now();
+	for (t = soft_timer_posted; t; t = t->posted) {
+		t->is_posted = 0;
+	}
+	soft_timer_posted = NULL;
+}
+
+/*! \brief Start or restart a timer
+*
+* \param timer  Timer, restarted if running
+* \param delay  RTC ticks until the first expiry, see SOFT_TIMER_MS()
+* \param period RTC ticks between later expiries, 0 for a one-shot timer
+* \param cb     Called from soft_timer_process() at each expiry
+*/
+void soft_timer_start(soft_timer_t *timer, rtc_time_t delay, rtc_time_t period, soft_timer_cb_t cb)
+{
+	PROFILE_BEGIN(PROFILE_TIMER_START);
+	if (soft_timer_active(timer)) {
+		soft_timer_unlink(timer);
+	}
+	timer->expires = RTC_0_now() + delay;
+	timer->period  = period;
+	timer->cb      = cb;
+	soft_timer_link(timer);
+
+	if (!soft_timer_armed || (rtc_stime_t)(timer->expires - soft_timer_deadline) < 0) {
+		soft_timer_arm(timer->expires);
+	}
+	PROFILE_END(PROFILE_TIMER_START);
+}
+
+/*! \brief Stop a timer, nothing happens if it is not running
+*/
+void soft_timer_cancel(soft_timer_t *timer)
+{
+	PROFILE_BEGIN(PROFILE_TIMER_CANCEL);
+	if (soft_timer_active(timer)) {
+		soft_timer_unlink(timer);
+	}
+	PROFILE_END(PROFILE_TIMER_CANCEL);
+}
+
+/*! \brief Run the callback of a timer from the next soft_timer_process()
+*
+* For an interrupt that needs work done outside of it: the callback runs
+* from the main loop as soon as it is back, the expiry and period of the
+* timer are not changed. Posting a timer twice before it ran runs it once,
+* a timer cancelled meanwhile is not run. Safe from an interrupt.
+*/
+void soft_timer_post(soft_timer_t *timer)
+{
+	ENTER_CRITICAL(P);
+	if (!timer->is_posted) {
+		timer->is_posted  = 1;
+		timer->posted     = soft_timer_posted;
+		soft_timer_posted = timer;
+	}
+	soft_timer_expired = 1;
+	EXIT_CRITICAL(P);
+}
+
+/*! \brief Check if soft_timer_process() has callbacks to run
+*
+* Read it with interrupts disabled before going to sleep.
+*/
+uint8_t soft_timer_pending(void)
+{
+	return soft_timer_expired;
+}
+
+/*! \brief Run the callbacks of the expired timers
+*
+* Call it from the main loop. Does nothing until the RTC compare fired, so
+* it is cheap to call on every pass. Expired timers are first moved to a
+* private list so the callbacks can start and cancel any timer, including
+* one expired in the same pass. A timer that comes due while the callbacks
+* run is left for the next pass, which starts from the slots of this one.
+*
+* \return Number of callbacks run
+*/
+uint8_t soft_timer_process(void)
+{
+	soft_timer_t *expired = NULL;
+	soft_timer_t *posted;
+	soft_timer_t *t, *next;
+	rtc_time_t    now, slots;
+	uint8_t       n = 0;
+	uint8_t       slot, i;
+
+	if (!soft_timer_expired) {
+		return 0;
+	}
+	PROFILE_BEGIN(PROFILE_TIMER_PROCESS);
+	ENTER_CRITICAL(P);
+	soft_timer_expired = 0;
+	posted             = soft_timer_posted;
+	soft_timer_posted  = NULL;
+	EXIT_CRITICAL(P);
+	now = RTC_0_now();
+
+	/* Slots from the last pass up to now, the whole wheel at most */
+	slot  = SLOT_OF(soft_timer_scanned);
+	slots = (now - (soft_timer_scanned & ~(rtc_time_t)((1 << SOFT_TIMER_SLOT_SHIFT) - 1))) >> SOFT_TIMER_SLOT_SHIFT;
+	for (i = 0;; i++, slot = (slot + 1) & (SOFT_TIMER_SLOTS - 1)) {
+		for (t = soft_timer_wheel[slot]; t; t = next) {
+			next = t->next;
+			if ((rtc_stime_t)(now - t->expires) >= 0) {
+				soft_timer_unlink(t);
+				soft_timer_push(&expired, t);
+			}
+		}
+		if (i == slots || i == SOFT_TIMER_SLOTS - 1) {
+			break;
+		}
+	}
+
+	soft_timer_scanned = now;
+	PROFILE_END(PROFILE_TIMER_PROCESS); /* The callbacks are the application's, e.g. a ~20 ms recalibration */
+
+	while ((t = expired) != NULL) {
+		soft_timer_unlink(t);
+		if (t->period) {
+			t->expires += t->period;
+			soft_timer_link(t);
+			if ((rtc_stime_t)(t->expires - soft_timer_scanned) < 0) {
+				soft_timer_scanned = t->expires; /* Still overdue, take it on the next pass */
+			}
+		}
+		t->cb(t);
+		n++;
+	}
+
+	for (t = posted; t; t = next) {
+		next         = t->posted;
+		t->is_posted = 0;
+		if (soft_timer_active(t)) {
+			t->cb(t);
+			n++;
+		}
+	}
+
+	PROFILE_BEGIN(PROFILE_TIMER_REARM);
+	soft_timer_rearm();
+	PROFILE_END(PROFILE_TIMER_REARM);
+	return n;
+}
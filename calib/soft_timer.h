@@ -0,0 +1,78 @@
+/*
+ * soft_timer.h
+ */
+
+
+#ifndef SOFT_TIMER_H_
+#define SOFT_TIMER_H_
+
+#include <compiler.h>
+#include <rtc.h>
+
+/*! Software timers on the RTC compare channel, as a hashed timing wheel.
+ *
+ * Time is cut in slots of 2^SOFT_TIMER_SLOT_SHIFT RTC ticks. A timer is
+ * linked in slot (expiry / slot size) % SOFT_TIMER_SLOTS, whatever round
+ * of the wheel it expires in, so start and cancel are O(1): a list head
+ * insert or unlink and one bit in the slot bitmap.
+ *
+ * Only the earliest deadline is programmed into RTC.CMP. It is looked up
+ * when the timers are processed or when a start moves it earlier, by
+ * skipping empty slots 8 at a time in the bitmap and walking the first
+ * busy slot. Cancel never reprograms, a cancelled deadline just costs one
+ * empty processing pass.
+ *
+ * The RTC interrupt only flags the expiry; callbacks run from
+ * soft_timer_process() in the main loop, so they may start and cancel
+ * timers freely.
+ *
+ * Overhead (estimates, 5 MHz, from the generated code, PROFILE_TIMER_* to
+ * measure): start ~60 cycles plus the CMP reprogram when the new timer is
+ * the earliest (up to ~3 RTC clocks of CMP sync), cancel ~40 cycles
+ * whatever the number of timers. Finding the next deadline costs ~10
+ * cycles per busy byte of bitmap plus ~20 cycles per timer of the first
+ * busy slot, so it grows with timers/SOFT_TIMER_SLOTS, not with the number
+ * of timers; keep SOFT_TIMER_SLOTS near the number of running timers.
+ */
+
+//! Wheel size, a multiple of 8
+#define SOFT_TIMER_SLOTS 32
+//! Slot width is 2^SOFT_TIMER_SLOT_SHIFT RTC ticks, 32 ticks ~ 1 ms
+#define SOFT_TIMER_SLOT_SHIFT 5
+
+#if SOFT_TIMER_SLOTS % 8 || SOFT_TIMER_SLOTS > 256
+#error SOFT_TIMER_SLOTS must be a multiple of 8, up to 256
+#endif
+
+//! Convert milliseconds to RTC ticks, whole seconds apart so it does not overflow 32 bits
+#define SOFT_TIMER_MS(ms) ((rtc_time_t)(ms) / 1000 * 32768UL + (rtc_time_t)(ms) % 1000 * 32768UL / 1000)
+
+struct soft_timer;
+typedef void (*soft_timer_cb_t)(struct soft_timer *timer);
+
+/*! \brief One software timer, owned by the application
+ *
+ * Embed it in a larger structure to give the callback a context.
+ */
+typedef struct soft_timer {
+	struct soft_timer * next;
+	struct soft_timer **pprev;   // Link pointing to this timer, NULL while stopped
+	rtc_time_t          expires; // Extended RTC time, see RTC_0_now()
+	rtc_time_t          period;  // Reload for periodic timers, 0 for one-shot
+	soft_timer_cb_t     cb;
+	struct soft_timer * posted;  // Next in the list of soft_timer_post(), NULL at the end
+	volatile uint8_t    is_posted;
+} soft_timer_t;
+
+void soft_timer_init(void);
+void soft_timer_start(soft_timer_t *timer, rtc_time_t delay, rtc_time_t period, soft_timer_cb_t cb);
+void soft_timer_cancel(soft_timer_t *timer);
+void soft_timer_post(soft_timer_t *timer);
+uint8_t soft_timer_process(void);
+uint8_t soft_timer_next(rtc_time_t *when);
+uint8_t soft_timer_pending(void);
+
+//! Nonzero while the timer is running
+#define soft_timer_active(timer) ((timer)->pprev != NULL)
+
+#endif /* SOFT_TIMER_H_ */
@@ -36,6 +36,11 @@
  */
 #include <bod.h>
 #include <ccp.h>
+#include <clock_config.h>
+#include <util/delay.h>
+
+/** Voltage level monitor callback */
+bod_cb_t BOD_vlm_cb;
 
 /**
  * \brief Initialize Brownout Detector
@@ -54,3 +59,82 @@ int8_t BOD_init()
 
 	return 0;
 }
+
+/**
+ * \brief Call \a cb when VDD crosses the voltage level monitor threshold
+ *
+ * The VLM compares VDD with the BOD level (BODCFG fuse) plus 5, 15 or 25%,
+ * so it only works while the BOD is enabled by fuse in active mode.
+ *
+ * \param[in] level Threshold above the BOD level
+ * \param[in] cfg   Interrupt when VDD goes below, above or crosses it
+ * \param[in] cb    Called from the VLM interrupt
+ */
+void BOD_vlm_enable(BOD_VLMLVL_t level, BOD_VLMCFG_t cfg, bod_cb_t cb)
+{
+	BOD.INTCTRL  = 0;
+	BOD_vlm_cb   = cb;
+	BOD.VLMCTRLA = level;
+	BOD.INTFLAGS = BOD_VLMIF_bm;
+	BOD.INTCTRL  = cfg | 1 << BOD_VLMIE_bp;
+}
+
+/**
+ * \brief Stop the voltage level monitor interrupt
+ */
+void BOD_vlm_disable(void)
+{
+	BOD.INTCTRL = 0;
+}
+
+/**
+ * \brief Find the supply band by stepping the VLM threshold up
+ *
+ * The VLM interrupt is held off while probing and the flag raised by the
+ * threshold changes is dropped; call BOD_vlm_watch_band() afterwards, the
+ * threshold is left on the last level probed. About 3 x BOD_VLM_SETTLE_US.
+ *
+ * \return Supply band, 0 to BOD_VLM_BANDS - 1
+ */
+uint8_t BOD_vlm_band(void)
+{
+	uint8_t intctrl = BOD.INTCTRL;
+	uint8_t band;
+
+	BOD.INTCTRL = 0;
+	for (band = 0; band < BOD_VLM_BANDS - 1; band++) {
+		BOD.VLMCTRLA = BOD_VLMLVL_5ABOVE_gc + band;
+		_delay_us(BOD_VLM_SETTLE_US);
+		if (BOD_vdd_below_vlm()) {
+			break;
+		}
+	}
+	BOD.INTFLAGS = BOD_VLMIF_bm;
+	BOD.INTCTRL  = intctrl;
+
+	return band;
+}
+
+/**
+ * \brief Interrupt when VDD leaves \a band downwards
+ *
+ * Only one threshold can be watched: falling is the direction that matters
+ * for the oscillator and the brown-out, a rise is found by probing again
+ * with BOD_vlm_band(). In band 0 the rise back above +5% is watched.
+ * The callback given to BOD_vlm_enable() is kept.
+ *
+ * \param[in] band Current supply band
+ */
+void BOD_vlm_watch_band(uint8_t band)
+{
+	BOD.INTCTRL = 0;
+	if (band == 0) {
+		BOD.VLMCTRLA = BOD_VLMLVL_5ABOVE_gc;
+		BOD.INTFLAGS = BOD_VLMIF_bm;
+		BOD.INTCTRL  = BOD_VLMCFG_ABOVE_gc | 1 << BOD_VLMIE_bp;
+	} else {
+		BOD.VLMCTRLA = BOD_VLMLVL_5ABOVE_gc + band - 1;
+		BOD.INTFLAGS = BOD_VLMIF_bm;
+		BOD.INTCTRL  = BOD_VLMCFG_BELOW_gc | 1 << BOD_VLMIE_bp;
+	}
+}
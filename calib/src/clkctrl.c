@@ -36,6 +36,11 @@
  */
 #include <clkctrl.h>
 #include <ccp.h>
+#include <clock_config.h>
+#include <util/delay.h>
+/** CLK_PER prescaler selected by MCLKCTRLB.PDIV */
+static const uint8_t CLKCTRL_pdiv[] = {2, 4, 8, 16, 32, 64, 1, 1, 6, 10, 12, 24, 48, 1, 1, 1};
+
 /**
  * \brief Initialize clkctrl interface
  *
@@ -43,20 +48,13 @@
  */
 int8_t CLKCTRL_init()
 {
+	static const init_table_entry_t init[] = {CLKCTRL_INIT_TABLE};
 
 	// ccp_write_io((void*)&(CLKCTRL.OSC32KCTRLA),0 << CLKCTRL_RUNSTDBY_bp /* Run standby: disabled */);
 
-	ccp_write_io((void *)&(CLKCTRL.XOSC32KCTRLA),
-	             CLKCTRL_CSUT_1K_gc             /* 1k cycles */
-	                 | 1 << CLKCTRL_ENABLE_bp   /* Enable: enabled */
-	                 | 0 << CLKCTRL_RUNSTDBY_bp /* Run standby: disabled */
-	                 | 0 << CLKCTRL_SEL_bp /* Select: disabled */);
-
 	// ccp_write_io((void*)&(CLKCTRL.OSC20MCTRLA),0 << CLKCTRL_RUNSTDBY_bp /* Run standby: disabled */);
 
-	ccp_write_io((void *)&(CLKCTRL.MCLKCTRLB),
-	             CLKCTRL_PDIV_4X_gc /* 4 */
-	                 | 1 << CLKCTRL_PEN_bp /* Prescaler enable: enabled */);
+	init_table_apply(init, ARRAY_SIZE(init));
 
 	// ccp_write_io((void*)&(CLKCTRL.MCLKCTRLA),CLKCTRL_CLKSEL_OSC20M_gc /* 20MHz Internal Oscillator (OSC20M) */
 	//		 | 0 << CLKCTRL_CLKOUT_bp /* System clock out: disabled */);
@@ -65,3 +63,55 @@ int8_t CLKCTRL_init()
 
 	return 0;
 }
+
+/**
+ * \brief Wait until the 32.768kHz crystal oscillator is stable
+ *
+ * XOSC32K is started by CLKCTRL_init(). Its start-up time depends on the
+ * crystal, so this polls MCLKSTATUS.XOSC32KS instead of waiting a fixed delay.
+ *
+ * \param[in] timeout_ms Maximum time to wait, in milliseconds
+ *
+ * \return 0 when the crystal is stable, -1 on timeout.
+ */
+int8_t CLKCTRL_wait_xosc32k_stable(uint16_t timeout_ms)
+{
+	uint32_t polls = (uint32_t)timeout_ms * 100;
+
+	while (!(CLKCTRL.MCLKSTATUS & CLKCTRL_XOSC32KS_bm)) {
+		if (polls-- == 0) {
+			return -1;
+		}
+		_delay_us(10);
+	}
+
+	return 0;
+}
+
+/**
+ * \brief Nominal OSC20M frequency selected by the FREQSEL fuse
+ *
+ * Read at run time, so one build serves units fused for 16 MHz and for
+ * 20 MHz.
+ *
+ * \return 16000000 or 20000000
+ */
+uint32_t CLKCTRL_osc20m_nominal_hz(void)
+{
+	return (FUSE.OSCCFG & FUSE_FREQSEL_gm) == FUSE_FREQSEL_16MHZ_gc ? 16000000UL : 20000000UL;
+}
+
+/**
+ * \brief Division from the main clock to CLK_PER
+ *
+ * \return The MCLKCTRLB prescaler, 1 when it is disabled
+ */
+uint8_t CLKCTRL_prescaler(void)
+{
+	uint8_t b = CLKCTRL.MCLKCTRLB;
+
+	if (!(b & CLKCTRL_PEN_bm)) {
+		return 1;
+	}
+	return CLKCTRL_pdiv[(b & CLKCTRL_PDIV_gm) >> CLKCTRL_PDIV_gp];
+}
@@ -52,9 +52,55 @@ int8_t CPUINT_init()
 	//		 | 0 << CPUINT_IVSEL_bp /* Interrupt Vector Select: disabled */
 	//		 | 0 << CPUINT_LVL0RR_bp /* Round-robin Scheduling Enable: disabled */);
 
-	// CPUINT.LVL0PRI = 0x0 << CPUINT_LVL0PRI_gp; /* Interrupt Level Priority: 0x0 */
+	CPUINT_set_round_robin(CPUINT_ROUND_ROBIN);
 
-	// CPUINT.LVL1VEC = 0x0 << CPUINT_LVL1VEC_gp; /* Interrupt Vector with High Priority: 0x0 */
+	CPUINT.LVL0PRI = CPUINT_LVL0_PRIORITY << CPUINT_LVL0PRI_gp; /* Interrupt Level Priority */
+
+	CPUINT.LVL1VEC = CPUINT_LVL1_VECTOR << CPUINT_LVL1VEC_gp; /* Interrupt Vector with High Priority */
+
+	/* Interrupts stay disabled: main() enables them once the clock is calibrated */
 
 	return 0;
 }
+
+/**
+ * \brief Give one interrupt vector level 1 (high priority)
+ *
+ * A level 1 interrupt preempts any running level 0 handler, so its entry
+ * latency no longer depends on the other handlers, only on the longest
+ * cli section. Only one vector can have level 1.
+ *
+ * \param[in] vector_num Vector number, e.g. RTC_CNT_vect_num, 0 for none
+ */
+void CPUINT_set_level1_vector(uint8_t vector_num)
+{
+	CPUINT.LVL1VEC = vector_num;
+}
+
+/**
+ * \brief Set the static level 0 priority
+ *
+ * The vector after \a vector_num has the highest level 0 priority, then
+ * the priority decreases with the vector number and wraps around.
+ * Round-robin scheduling updates this register by itself.
+ *
+ * \param[in] vector_num Vector number, 0 for the default order
+ */
+void CPUINT_set_level0_priority(uint8_t vector_num)
+{
+	CPUINT.LVL0PRI = vector_num;
+}
+
+/**
+ * \brief Enable or disable round-robin scheduling of level 0 interrupts
+ *
+ * CPUINT.CTRLA is configuration change protected.
+ *
+ * \param[in] enable 1 to rotate the level 0 priority after each interrupt
+ */
+void CPUINT_set_round_robin(uint8_t enable)
+{
+	uint8_t ctrla = CPUINT.CTRLA & ~CPUINT_LVL0RR_bm;
+
+	ccp_write_io_inline(CPUINT.CTRLA, ctrla | (enable ? CPUINT_LVL0RR_bm : 0));
+}
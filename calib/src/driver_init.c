@@ -35,6 +35,7 @@
 
 #include "driver_init.h"
 #include <system.h>
+#include <profile.h>
 
 void PWM_0_initialization(void)
 {
@@ -53,22 +54,39 @@ void PWM_0_initialization(void)
 	PWM_0_init();
 }
 
+/**
+ * \brief Boot configuration of all drivers, in the order it is applied
+ *
+ * Reorder the groups here to change the startup sequence. SLPCTRL and BOD
+ * keep their reset configuration, so they have no entries.
+ */
+static const init_table_entry_t system_init_table[] = {
+    /* Start XOSC32K first so the crystal settles while the rest of the
+     * system is initialized. InitCalibRc() waits for it to be stable. */
+    CLKCTRL_INIT_TABLE,
+    MCU_INIT_TABLE,
+    RTC_0_INIT_TABLE,
+    /* PWM_0 pin: PB1 output, initial level low */
+    INIT_REG(PORTB.OUTCLR, 1 << 1),
+    INIT_REG(PORTB.DIRSET, 1 << 1),
+    PWM_0_INIT_TABLE,
+};
+
 /**
  * \brief System initialization
  */
 void system_init()
 {
-	mcu_init();
+	PROFILE_INIT();
+	PROFILE_BEGIN(PROFILE_SYSTEM_INIT);
 
-	CLKCTRL_init();
-
-	RTC_0_init();
-
-	PWM_0_initialization();
+	PROFILE_BEGIN(PROFILE_INIT_TABLE);
+	init_table_apply(system_init_table, ARRAY_SIZE(system_init_table));
+	PROFILE_END(PROFILE_INIT_TABLE);
 
+	PROFILE_BEGIN(PROFILE_CPUINT_INIT);
 	CPUINT_init();
+	PROFILE_END(PROFILE_CPUINT_INIT);
 
-	SLPCTRL_init();
-
-	BOD_init();
+	PROFILE_END(PROFILE_SYSTEM_INIT);
 }
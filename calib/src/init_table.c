@@ -0,0 +1,32 @@
+/*
+ * init_table.c
+ */
+
+#include <init_table.h>
+#include <protected_io.h>
+
+/*! \brief Apply an initialization table
+*
+* Writes every entry in order. Protected entries go through the CCP
+* handshake, fill entries write the same value to consecutive registers
+* (e.g. PIN0CTRL..PIN7CTRL of a port).
+*
+* \param entry First entry of the table
+* \param n     Number of entries
+*/
+void init_table_apply(const init_table_entry_t *entry, uint8_t n)
+{
+	for (; n; n--, entry++) {
+		register8_t *reg   = entry->addr;
+		uint8_t      value = entry->value;
+		uint8_t      count = entry->flags;
+
+		if (count & INIT_TABLE_CCP) {
+			protected_write_io((void *)reg, CCP_IOREG_gc, value);
+		} else {
+			do {
+				*reg++ = value;
+			} while (--count);
+		}
+	}
+}
@@ -35,6 +35,21 @@
  *@{
  */
 #include <pwm_basic.h>
+#include <clock_config.h>
+#include <atomic.h>
+
+/** Callback function for the overflow interrupt */
+pwm_irq_cb_t PWM_0_cb = NULL;
+
+/** TCA0 clock dividers selectable by CTRLA.CLKSEL, as shift counts */
+static const uint8_t PWM_0_div_shift[] = {0, 1, 2, 3, 4, 6, 8, 10};
+
+/** CLK_PER the period is computed from, F_CPU until a measurement arrives */
+static uint32_t PWM_0_clk_hz = F_CPU;
+/** Requested output frequency, 0 when PWM_0_set_frequency() is not used */
+static uint32_t PWM_0_freq_hz;
+/** Requested duty per channel, PWM_0_DUTY_UNMANAGED when not used */
+static uint16_t PWM_0_duty_pm[3] = {PWM_0_DUTY_UNMANAGED, PWM_0_DUTY_UNMANAGED, PWM_0_DUTY_UNMANAGED};
 
 /**
  * \brief Initialize PWM
@@ -45,21 +60,14 @@
  */
 int8_t PWM_0_init()
 {
+	static const init_table_entry_t init[] = {PWM_0_INIT_TABLE};
 
 	// TCA0.SINGLE.CMP0 = 0x0; /* Setting: 0x0 */
 
-	TCA0.SINGLE.CMP1 = 0x1f4; /* Setting: 0x1f4 */
-
 	// TCA0.SINGLE.CMP2 = 0x0; /* Setting: 0x0 */
 
 	// TCA0.SINGLE.CNT = 0x0; /* Count: 0x0 */
 
-	TCA0.SINGLE.CTRLB = 0 << TCA_SINGLE_ALUPD_bp            /* Auto Lock Update: disabled */
-	                    | 0 << TCA_SINGLE_CMP0EN_bp         /* Setting: disabled */
-	                    | 1 << TCA_SINGLE_CMP1EN_bp         /* Setting: enabled */
-	                    | 0 << TCA_SINGLE_CMP2EN_bp         /* Setting: disabled */
-	                    | TCA_SINGLE_WGMODE_SINGLESLOPE_gc; /*  */
-
 	// TCA0.SINGLE.CTRLC = 0 << TCA_SINGLE_CMP0OV_bp /* Setting: disabled */
 	//		 | 0 << TCA_SINGLE_CMP1OV_bp /* Setting: disabled */
 	//		 | 0 << TCA_SINGLE_CMP2OV_bp; /* Setting: disabled */
@@ -74,14 +82,34 @@ int8_t PWM_0_init()
 	//		 | 0 << TCA_SINGLE_CMP2_bp /* Compare 2 Interrupt: disabled */
 	//		 | 0 << TCA_SINGLE_OVF_bp; /* Overflow Interrupt Enable: disabled */
 
-	TCA0.SINGLE.PER = 0x3e8; /* Top Value: 0x3e8 */
-
-	TCA0.SINGLE.CTRLA = TCA_SINGLE_CLKSEL_DIV1_gc /* System Clock */
-	                    | 1 << TCA_SINGLE_ENABLE_bp /* Module Enable: enabled */;
+	init_table_apply(init, ARRAY_SIZE(init));
 
 	return 0;
 }
 
+/**
+ * \brief Register a callback called on TCA0 overflow
+ *
+ * The callback is called every PWM_0_INTERRUPT_CB_RATE periods.
+ * Registering NULL disables the overflow interrupt.
+ *
+ * \param[in] f Callback function, NULL to stop the callbacks
+ *
+ * \return Nothing
+ */
+void PWM_0_register_callback(pwm_irq_cb_t f)
+{
+	TCA0.SINGLE.INTCTRL &= ~TCA_SINGLE_OVF_bm;
+	PWM_0_cb = f;
+	if (f != NULL) {
+#if PWM_0_INTERRUPT_CB_RATE > 1
+		GPIOR3 = PWM_0_INTERRUPT_CB_RATE; /* Rate divider, see driver_isr.c */
+#endif
+		TCA0.SINGLE.INTFLAGS = TCA_SINGLE_OVF_bm;
+		TCA0.SINGLE.INTCTRL |= TCA_SINGLE_OVF_bm;
+	}
+}
+
 /**
  * \brief Enable PWM_0
  * 1. If supported by the clock system, enables the clock to the PWM
@@ -175,7 +203,9 @@ void PWM_0_disable_output_ch2()
  */
 void PWM_0_load_counter(PWM_0_register_t counter_value)
 {
+	ENTER_CRITICAL(W); /* 16-bit write through TEMP, shared with the TCA0 interrupts */
 	TCA0.SINGLE.CNT = counter_value;
+	EXIT_CRITICAL(W);
 }
 
 /**
@@ -188,7 +218,9 @@ void PWM_0_load_counter(PWM_0_register_t counter_value)
  */
 void PWM_0_load_top(PWM_0_register_t top_value)
 {
+	ENTER_CRITICAL(W); /* 16-bit write through TEMP, shared with the TCA0 interrupts */
 	TCA0.SINGLE.PERBUF = top_value;
+	EXIT_CRITICAL(W);
 }
 
 /**
@@ -203,7 +235,9 @@ void PWM_0_load_top(PWM_0_register_t top_value)
  */
 void PWM_0_load_duty_cycle_ch0(PWM_0_register_t duty_value)
 {
+	ENTER_CRITICAL(W); /* 16-bit write through TEMP, shared with the TCA0 interrupts */
 	TCA0.SINGLE.CMP0BUF = duty_value;
+	EXIT_CRITICAL(W);
 }
 
 /**
@@ -218,7 +252,9 @@ void PWM_0_load_duty_cycle_ch0(PWM_0_register_t duty_value)
  */
 void PWM_0_load_duty_cycle_ch1(PWM_0_register_t duty_value)
 {
+	ENTER_CRITICAL(W); /* 16-bit write through TEMP, shared with the TCA0 interrupts */
 	TCA0.SINGLE.CMP1BUF = duty_value;
+	EXIT_CRITICAL(W);
 }
 
 /**
@@ -233,5 +269,212 @@ void PWM_0_load_duty_cycle_ch1(PWM_0_register_t duty_value)
  */
 void PWM_0_load_duty_cycle_ch2(PWM_0_register_t duty_value)
 {
+	ENTER_CRITICAL(W); /* 16-bit write through TEMP, shared with the TCA0 interrupts */
 	TCA0.SINGLE.CMP2BUF = duty_value;
+	EXIT_CRITICAL(W);
+}
+
+/**
+ * \brief Load TOP and all three duty cycle registers as one transaction
+ *
+ * PERBUF and CMP0BUF-CMP2BUF are written under lock update (LUPD), so the
+ * hardware takes all of them over at the same UPDATE event: a period never
+ * mixes old and new values. Interrupts are held off for the 8 byte stores
+ * (shared TEMP register), about 33 cycles; 36 cycles for the whole call
+ * body. Safe to call from an ISR.
+ *
+ * \param[in] update New TOP and compare values
+ *
+ * \return Nothing
+ */
+void PWM_0_load_all(const PWM_0_update_t *update)
+{
+	ENTER_CRITICAL(W);
+	TCA0.SINGLE.CTRLESET = TCA_SINGLE_LUPD_bm;
+	TCA0.SINGLE.PERBUF   = update->top;
+	TCA0.SINGLE.CMP0BUF  = update->duty[0];
+	TCA0.SINGLE.CMP1BUF  = update->duty[1];
+	TCA0.SINGLE.CMP2BUF  = update->duty[2];
+	TCA0.SINGLE.CTRLECLR = TCA_SINGLE_LUPD_bm;
+	EXIT_CRITICAL(W);
+}
+
+/**
+ * \brief TOP giving \a ticks CLK_PER cycles per period with prescaler \a sel
+ *
+ * \return TOP, outside 1..0xFFFF if the period cannot be generated this way
+ */
+static uint32_t PWM_0_top_for(uint32_t ticks, uint8_t sel, uint8_t dual)
+{
+	uint32_t counts = ticks >> (PWM_0_div_shift[sel] + dual); /* Dual slope counts up and down */
+
+	return dual ? counts : counts - 1;
+}
+
+/**
+ * \brief Recompute TOP and the managed duty cycles from the current clock
+ *
+ * PERBUF and CMPnBUF are written under lock update so they are taken over
+ * together at the next UPDATE, the running period is never cut.
+ * The prescaler is not buffered, so it is only changed when the new period
+ * does not fit the current one.
+ *
+ * \return 0 on success, -1 if the frequency cannot be generated.
+ */
+static int8_t PWM_0_update_period(void)
+{
+	uint32_t ticks, t;
+	uint16_t top;
+	uint8_t  sel, cur, dual;
+
+	if (PWM_0_freq_hz == 0) {
+		return 0;
+	}
+
+	ticks = (PWM_0_clk_hz + PWM_0_freq_hz / 2) / PWM_0_freq_hz; /* CLK_PER cycles per period */
+	cur   = (TCA0.SINGLE.CTRLA & TCA_SINGLE_CLKSEL_gm) >> TCA_SINGLE_CLKSEL_gp;
+	dual  = PWM_0_is_dual_slope();
+
+	/* Keep the running prescaler if possible, else take the smallest that fits */
+	t = PWM_0_top_for(ticks, cur, dual);
+	if (t >= 1 && t <= 0xFFFF) {
+		sel = cur;
+	} else {
+		for (sel = 0; sel < ARRAY_SIZE(PWM_0_div_shift); sel++) {
+			t = PWM_0_top_for(ticks, sel, dual);
+			if (t <= 0xFFFF) {
+				break;
+			}
+		}
+		if (sel == ARRAY_SIZE(PWM_0_div_shift) || t < 1) {
+			return -1;
+		}
+	}
+	top = t;
+
+	ENTER_CRITICAL(W);
+	TCA0.SINGLE.CTRLESET = TCA_SINGLE_LUPD_bm;
+	if (sel != cur) {
+		TCA0.SINGLE.CTRLA = (TCA0.SINGLE.CTRLA & ~TCA_SINGLE_CLKSEL_gm) | (sel << TCA_SINGLE_CLKSEL_gp);
+	}
+	TCA0.SINGLE.PERBUF = top;
+	for (uint8_t ch = 0; ch < 3; ch++) {
+		if (PWM_0_duty_pm[ch] != PWM_0_DUTY_UNMANAGED) {
+			/* Full period is PER + 1 counts in single slope, PER in dual slope;
+			 * the sum is taken in 32 bits, it is 0x10000 at TOP = 0xFFFF */
+			t = (((uint32_t)top + !dual) * PWM_0_duty_pm[ch] + 500) / 1000;
+			(&TCA0.SINGLE.CMP0BUF)[ch] = t > 0xFFFF ? 0xFFFF : t;
+		}
+	}
+	TCA0.SINGLE.CTRLECLR = TCA_SINGLE_LUPD_bm;
+	EXIT_CRITICAL(W);
+
+	return 0;
+}
+
+/**
+ * \brief Select the waveform generation mode of PWM_0
+ *
+ * The timer is stopped, switched, restarted from BOTTOM and TOP and the
+ * managed duty cycles are recomputed for the new mode, so the output
+ * frequency and duty set with PWM_0_set_frequency() and
+ * PWM_0_set_duty_permille() are kept. Raw PER/CMP values loaded by hand
+ * are not converted: switching to a dual-slope mode halves their frequency.
+ * The outputs are restarted, so call this while the power stage is idle.
+ *
+ * \param[in] mode SINGLESLOPE, DSTOP, DSBOTTOM or DSBOTH, see pwm_basic.h
+ *
+ * \return 0 on success, -1 if the mode is not a PWM mode or the frequency
+ *         cannot be generated in it.
+ */
+int8_t PWM_0_set_mode(TCA_SINGLE_WGMODE_t mode)
+{
+	uint8_t ctrla;
+	int8_t  ret;
+
+	switch (mode) {
+	case TCA_SINGLE_WGMODE_SINGLESLOPE_gc:
+	case TCA_SINGLE_WGMODE_DSTOP_gc:
+	case TCA_SINGLE_WGMODE_DSBOTH_gc:
+	case TCA_SINGLE_WGMODE_DSBOTTOM_gc:
+		break;
+	default:
+		return -1;
+	}
+
+	ctrla = TCA0.SINGLE.CTRLA;
+	TCA0.SINGLE.CTRLA = ctrla & ~TCA_SINGLE_ENABLE_bm;
+	TCA0.SINGLE.CTRLB = (TCA0.SINGLE.CTRLB & ~TCA_SINGLE_WGMODE_gm) | mode;
+
+	ret = PWM_0_update_period(); /* May change the prescaler */
+
+	TCA0.SINGLE.CTRLESET = TCA_SINGLE_CMD_UPDATE_gc; /* Take the buffers over now */
+	TCA0.SINGLE.CTRLESET = TCA_SINGLE_CMD_RESTART_gc;
+	TCA0.SINGLE.CTRLA    = (TCA0.SINGLE.CTRLA & ~TCA_SINGLE_ENABLE_bm) | (ctrla & TCA_SINGLE_ENABLE_bm);
+
+	return ret;
+}
+
+/**
+ * \brief Set the PWM_0 output frequency
+ *
+ * TOP and the prescaler are computed from the measured CLK_PER (see
+ * PWM_0_clock_changed()), so the output stays on frequency whatever the
+ * oscillator error is.
+ *
+ * \param[in] hz Output frequency in Hz
+ *
+ * \return 0 on success, -1 if the frequency cannot be generated.
+ */
+int8_t PWM_0_set_frequency(uint32_t hz)
+{
+	PWM_0_freq_hz = hz;
+	return PWM_0_update_period();
+}
+
+/**
+ * \brief Set the duty cycle of a channel in 1/1000 of the period
+ *
+ * The compare value follows later frequency and clock changes.
+ * PWM_0_DUTY_UNMANAGED releases the channel: its compare value is left
+ * as it is and no longer rewritten.
+ *
+ * \param[in] channel PWM channel, 0 to 2
+ * \param[in] permille Duty cycle, 0 to 1000, or PWM_0_DUTY_UNMANAGED
+ *
+ * \return Nothing
+ */
+void PWM_0_set_duty_permille(uint8_t channel, uint16_t permille)
+{
+	if (channel > 2) {
+		return;
+	}
+	if (permille == PWM_0_DUTY_UNMANAGED) {
+		PWM_0_duty_pm[channel] = permille;
+		return;
+	}
+	if (permille > 1000) {
+		permille = 1000;
+	}
+	PWM_0_duty_pm[channel] = permille;
+	PWM_0_update_period();
+}
+
+/**
+ * \brief Rescale PWM_0 to a new measured CLK_PER
+ *
+ * Registered with CalibAddClockCallback() so it runs after each calibration.
+ * Does nothing unless PWM_0_set_frequency() was used.
+ *
+ * \param[in] clk_hz Measured peripheral clock in Hz
+ *
+ * \return Nothing
+ */
+void PWM_0_clock_changed(uint32_t clk_hz)
+{
+	if (clk_hz == 0) {
+		return;
+	}
+	PWM_0_clk_hz = clk_hz;
+	PWM_0_update_period();
 }
@@ -0,0 +1,157 @@
+/*
+ * pwm_hires.c
+ */
+
+#include <pwm_hires.h>
+#include <atomic.h>
+
+/* The fraction is kept left aligned in 8 bits whatever PWM_HIRES_FRAC_BITS
+ * is, so an accumulator carry is simply "sum smaller than the addend". */
+static volatile uint16_t pwm_hires_base;   // Integer part of the compare value
+static volatile uint8_t  pwm_hires_frac;   // Fractional part, left aligned
+static uint8_t           pwm_hires_acc;    // Error accumulator, ISR side
+static register16_t *    pwm_hires_cmp;    // CMPnBUF of the dithered channel
+static uint16_t          pwm_hires_duty;   // Last pwm_hires_set_fraction()
+static uint8_t           pwm_hires_scaled; // Duty given as a fraction, rescaled on a clock change
+
+/*! \brief Load the dithered compare value, called from the TCA0 overflow interrupt
+*
+* CMPnBUF is taken over at the next UPDATE, i.e. for the next period.
+*/
+static void pwm_hires_isr(void)
+{
+	uint8_t  frac = pwm_hires_frac;
+	uint16_t cmp  = pwm_hires_base;
+
+	pwm_hires_acc += frac;
+	if (pwm_hires_acc < frac) {
+		cmp++;
+	}
+	*pwm_hires_cmp = cmp;
+}
+
+/*! \brief Start dithering a PWM_0 channel
+*
+* Takes over the PWM_0 overflow callback and takes the channel out of
+* PWM_0_set_duty_permille(), so PWM_0 no longer rewrites its compare value.
+* The channel starts from its current compare value with no fraction.
+*
+* \param channel PWM channel, 0 to 2
+*/
+void pwm_hires_start(uint8_t channel)
+{
+	if (channel > 2) {
+		channel = 2;
+	}
+	PWM_0_register_callback(NULL);
+	PWM_0_set_duty_permille(channel, PWM_0_DUTY_UNMANAGED);
+	pwm_hires_cmp = &TCA0.SINGLE.CMP0BUF + channel;
+	ENTER_CRITICAL(R); /* 16-bit access through TEMP, shared with the other TCA0 interrupts */
+	pwm_hires_base = *pwm_hires_cmp;
+	EXIT_CRITICAL(R);
+	pwm_hires_frac   = 0;
+	pwm_hires_acc    = 0;
+	pwm_hires_scaled = 0;
+	PWM_0_register_callback(pwm_hires_isr);
+}
+
+/*! \brief Stop dithering, the channel keeps the integer part of its value
+*
+* The channel stays out of PWM_0_set_duty_permille() until a duty is set
+* there again. Does nothing if pwm_hires_start() was never called.
+*/
+void pwm_hires_stop(void)
+{
+	if (pwm_hires_cmp == NULL) {
+		return;
+	}
+	PWM_0_register_callback(NULL);
+	pwm_hires_scaled = 0;
+	ENTER_CRITICAL(W);
+	*pwm_hires_cmp = pwm_hires_base;
+	EXIT_CRITICAL(W);
+}
+
+/*! \brief Load the base and the fraction of \a value
+*/
+static void pwm_hires_load(uint32_t value)
+{
+	uint16_t base = value >> PWM_HIRES_FRAC_BITS;
+	uint8_t  frac = (uint8_t)(value << (8 - PWM_HIRES_FRAC_BITS));
+
+	ENTER_CRITICAL(W);
+	pwm_hires_base = base;
+	pwm_hires_frac = frac;
+	EXIT_CRITICAL(W);
+}
+
+/*! \brief Set the compare value with fractional bits
+*
+* The value is in counts, it is not rescaled by pwm_hires_clock_changed().
+*
+* \param value Compare value << PWM_HIRES_FRAC_BITS, at most (PER + 1) << PWM_HIRES_FRAC_BITS
+*/
+void pwm_hires_set(uint32_t value)
+{
+	pwm_hires_scaled = 0;
+	pwm_hires_load(value);
+}
+
+/*! \brief Compare value << PWM_HIRES_FRAC_BITS for \a duty of a period of \a top
+*/
+static uint32_t pwm_hires_value(uint16_t top, uint16_t duty)
+{
+	/* Full period is PER + 1 counts in single slope, PER in dual slope */
+	uint32_t value = ((uint32_t)top + !PWM_0_is_dual_slope()) * duty;
+
+	return value >> (16 - PWM_HIRES_FRAC_BITS);
+}
+
+/*! \brief Set the duty cycle as a fraction of the current period
+*
+* Follows clock changes through pwm_hires_clock_changed(); must be called
+* again after PWM_0_set_frequency().
+*
+* \param duty Duty cycle in 1/65536 of the period
+*/
+void pwm_hires_set_fraction(uint16_t duty)
+{
+	uint16_t top;
+
+	ENTER_CRITICAL(R); /* The dither ISR writes CMPnBUF through TEMP */
+	top = TCA0.SINGLE.PER;
+	EXIT_CRITICAL(R);
+
+	pwm_hires_duty   = duty;
+	pwm_hires_scaled = 1;
+	pwm_hires_load(pwm_hires_value(top, duty));
+}
+
+/*! \brief Rescale the dithered channel to the new PWM_0 period
+*
+* Register with CalibAddClockCallback() after PWM_0_clock_changed(), which
+* has left the new TOP in PERBUF. A duty set with pwm_hires_set_fraction()
+* is recomputed from it and loaded into CMPnBUF together with PERBUF, and
+* the accumulator restarts as its carries are counts of the old period.
+* A value set with pwm_hires_set() is in counts and is kept as it is.
+*
+* \param clk_hz Measured peripheral clock in Hz, unused
+*/
+void pwm_hires_clock_changed(uint32_t clk_hz)
+{
+	uint32_t value;
+	uint16_t top;
+
+	(void)clk_hz;
+	if (pwm_hires_cmp == NULL || !pwm_hires_scaled) {
+		return;
+	}
+	ENTER_CRITICAL(W);
+	top            = TCA0.SINGLE.PERBUF;
+	value          = pwm_hires_value(top, pwm_hires_duty);
+	pwm_hires_base = value >> PWM_HIRES_FRAC_BITS;
+	pwm_hires_frac = (uint8_t)(value << (8 - PWM_HIRES_FRAC_BITS));
+	pwm_hires_acc  = 0;
+	*pwm_hires_cmp = pwm_hires_base; /* Taken over with PERBUF at the next UPDATE */
+	EXIT_CRITICAL(W);
+}
@@ -0,0 +1,37 @@
+/*
+ * pwm_split.c
+ */
+
+#include <pwm_split.h>
+
+/**
+ * \brief Initialize TCA0 in split mode
+ *
+ * Resets TCA0 (ending any PWM_0 use), routes the outputs through PORTMUX
+ * and makes the pins of the enabled channels outputs, driven low.
+ *
+ * \return Initialization status.
+ */
+int8_t PWM_SPLIT_0_init()
+{
+	static const init_table_entry_t init[] = {PWM_SPLIT_0_INIT_TABLE};
+	uint8_t                         default_pins, alt_pins;
+
+	/* Each WOn has its own PORTMUX_TCA0n_bm (bit n):
+	 * WO0-2 on PORTB 0-2, or PORTB 3-5 if alternate
+	 * WO3-5 on PORTA 3-5, or PORTC 3-5 if alternate
+	 */
+	default_pins = PWM_SPLIT_0_CHANNELS & ~PWM_SPLIT_0_PORTMUX;
+	alt_pins     = PWM_SPLIT_0_CHANNELS & PWM_SPLIT_0_PORTMUX;
+
+	PORTB.OUTCLR = (default_pins & 0x07) | (alt_pins & 0x07) << 3;
+	PORTB.DIRSET = (default_pins & 0x07) | (alt_pins & 0x07) << 3;
+	PORTA.OUTCLR = default_pins & 0x38;
+	PORTA.DIRSET = default_pins & 0x38;
+	PORTC.OUTCLR = alt_pins & 0x38;
+	PORTC.DIRSET = alt_pins & 0x38;
+
+	init_table_apply(init, ARRAY_SIZE(init));
+
+	return 0;
+}
@@ -0,0 +1,92 @@
+/*
+ * pwm_stream.c
+ */
+
+#include <pwm_stream.h>
+
+/* Slot i is owned by the application while len[i] == 0, by the ISR otherwise.
+ * The single byte store of len is the publish/release, no lock needed. */
+static const PWM_0_register_t *volatile pwm_stream_buf[2];
+static volatile uint8_t                 pwm_stream_len[2];
+static uint8_t                          pwm_stream_wr;  // Next slot to submit, application side
+static uint8_t                          pwm_stream_rd;  // Slot being played, ISR side
+static uint8_t                          pwm_stream_pos; // Next sample in the played slot, ISR side
+static register16_t *                   pwm_stream_cmp; // CMPnBUF of the streamed channel
+
+volatile uint16_t pwm_stream_underruns;
+
+/*! \brief Load the next sample, called from the TCA0 overflow interrupt
+*/
+static void pwm_stream_isr(void)
+{
+	uint8_t rd = pwm_stream_rd;
+	uint8_t len = pwm_stream_len[rd];
+
+	if (len == 0) {
+		pwm_stream_underruns++;
+		return;
+	}
+	*pwm_stream_cmp = pwm_stream_buf[rd][pwm_stream_pos];
+	if (++pwm_stream_pos == len) {
+		pwm_stream_pos      = 0;
+		pwm_stream_len[rd]  = 0;
+		pwm_stream_rd       = rd ^ 1;
+	}
+}
+
+/*! \brief Start streaming to a PWM_0 channel
+*
+* Takes over the PWM_0 overflow callback. Both slots start empty.
+*
+* \param channel PWM channel, 0 to 2
+*/
+void pwm_stream_start(uint8_t channel)
+{
+	PWM_0_register_callback(NULL);
+	pwm_stream_len[0]    = 0;
+	pwm_stream_len[1]    = 0;
+	pwm_stream_wr        = 0;
+	pwm_stream_rd        = 0;
+	pwm_stream_pos       = 0;
+	pwm_stream_underruns = 0;
+	pwm_stream_cmp       = &TCA0.SINGLE.CMP0BUF + (channel > 2 ? 2 : channel);
+	PWM_0_register_callback(pwm_stream_isr);
+}
+
+/*! \brief Stop streaming, the channel keeps its last duty
+*/
+void pwm_stream_stop(void)
+{
+	PWM_0_register_callback(NULL);
+}
+
+/*! \brief Queue a buffer of duty samples
+*
+* The buffer must stay untouched until its slot is released again
+* (pwm_stream_free_slots() going up). Safe to call from the main loop
+* while the ISR is playing.
+*
+* \param samples Compare values, one per PWM period
+* \param len     Number of samples, 1 to 255
+*
+* \return 0 if queued, -1 if both slots are in use
+*/
+int8_t pwm_stream_submit(const PWM_0_register_t *samples, uint8_t len)
+{
+	uint8_t wr = pwm_stream_wr;
+
+	if (len == 0 || pwm_stream_len[wr] != 0) {
+		return -1;
+	}
+	pwm_stream_buf[wr] = samples;
+	pwm_stream_len[wr] = len; // Publishes the slot to the ISR
+	pwm_stream_wr      = wr ^ 1;
+	return 0;
+}
+
+/*! \brief Number of slots the application can submit, 0 to 2
+*/
+uint8_t pwm_stream_free_slots(void)
+{
+	return (pwm_stream_len[0] == 0) + (pwm_stream_len[1] == 0);
+}
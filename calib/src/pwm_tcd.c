@@ -0,0 +1,243 @@
+/*
+ * pwm_tcd.c
+ */
+
+#include <pwm_tcd.h>
+#include <ccp.h>
+#include <clkctrl.h>
+#include <util/delay.h>
+
+/** Right shift of the TCD0 counter prescaler */
+#define PWM_TCD_0_CNTPRES_SHIFT                                                                                        \
+	(PWM_TCD_0_CNTPRES == TCD_CNTPRES_DIV32_gc ? 5 : PWM_TCD_0_CNTPRES == TCD_CNTPRES_DIV4_gc ? 2 : 0)
+
+/** OSC20M frequency, nominal until a measurement arrives */
+static uint32_t PWM_TCD_0_osc_hz = 20000000UL;
+static uint32_t PWM_TCD_0_freq_hz;
+static uint16_t PWM_TCD_0_duty_pm = 500;
+static uint16_t PWM_TCD_0_dead_ns;
+
+/** Compare values waiting for PWM_TCD_0_flush() */
+static uint16_t PWM_TCD_0_shadow[4]; // CMPASET, CMPACLR, CMPBSET, CMPBCLR
+static uint8_t  PWM_TCD_0_dirty;
+
+/**
+ * \brief Recompute the compare values for the current mode into the shadow
+ *
+ * \return 0 on success, -1 if the frequency does not fit the 12-bit counter.
+ */
+static int8_t PWM_TCD_0_update(void)
+{
+	uint32_t rate, counts;
+	uint16_t dead, on;
+
+	if (PWM_TCD_0_freq_hz == 0) {
+		return 0;
+	}
+
+	rate   = PWM_TCD_0_osc_hz >> PWM_TCD_0_CNTPRES_SHIFT;                 /* TCD counts per second */
+	counts = (rate + PWM_TCD_0_freq_hz / 2) / PWM_TCD_0_freq_hz;          /* Counts per PWM period */
+	dead   = ((uint32_t)PWM_TCD_0_dead_ns * (rate / 1000) + 500000UL) / 1000000UL;
+
+	if (counts < 2UL * dead + 2) {
+		return -1;
+	}
+	on = ((counts - 2 * dead) * PWM_TCD_0_duty_pm + 500) / 1000; /* WOA on time */
+	if (on < 1) {
+		on = 1;
+	} else if (on > counts - 2 * dead - 1) {
+		on = counts - 2 * dead - 1;
+	}
+
+	if ((TCD0.CTRLB & TCD_WGMODE_gm) == TCD_WGMODE_TWORAMP_gc) {
+		/* Ramp A = dead + on, ramp B = the rest, 4096 counts each at most */
+		if (dead + on > 4096 || counts - dead - on > 4096) {
+			return -1;
+		}
+		PWM_TCD_0_shadow[0] = dead;                   // A on after the dead time ...
+		PWM_TCD_0_shadow[1] = dead + on - 1;          // ... until the end of ramp A
+		PWM_TCD_0_shadow[2] = dead;                   // B on after the dead time ...
+		PWM_TCD_0_shadow[3] = counts - dead - on - 1; // ... until the end of ramp B
+	} else {
+		/* A single ramp of counts, WOA then WOB */
+		if (counts > 4096) {
+			return -1;
+		}
+		PWM_TCD_0_shadow[0] = dead;                   // A on after the dead time ...
+		PWM_TCD_0_shadow[1] = dead + on;              // ... for the duty
+		PWM_TCD_0_shadow[2] = 2 * dead + on;          // B on after the dead time ...
+		PWM_TCD_0_shadow[3] = counts - 1;             // ... until TOP
+	}
+	PWM_TCD_0_dirty = 1;
+	PWM_TCD_0_flush();
+
+	return 0;
+}
+
+/**
+ * \brief Initialize TCD0 for complementary PWM on PA4/PA5
+ *
+ * The timer is left disabled with both outputs enabled and low, call
+ * PWM_TCD_0_set_frequency() and PWM_TCD_0_enable() to start it.
+ *
+ * \return Initialization status.
+ */
+int8_t PWM_TCD_0_init()
+{
+	TCD0.CTRLA = TCD_CLKSEL_20MHZ_gc /* 20MHz oscillator, not CLK_PER */
+	             | PWM_TCD_0_CNTPRES | TCD_SYNCPRES_DIV1_gc;
+	TCD0.CTRLB = TCD_WGMODE_ONERAMP_gc;
+	ccp_write_io_inline(TCD0.FAULTCTRL, TCD_CMPAEN_bm | TCD_CMPBEN_bm);
+
+	PORTA.OUTCLR = 1 << 4 | 1 << 5;
+	PORTA.DIRSET = 1 << 4 | 1 << 5;
+
+	return 0;
+}
+
+/**
+ * \brief Enable TCD0, the compare values are taken over at start
+ *
+ * ENRDY is cleared while a previous disable is synchronized to the TCD
+ * clock domain, which takes a few TCD clocks. It is polled for at most
+ * PWM_TCD_0_ENRDY_TIMEOUT_US, e.g. if the TCD clock does not run.
+ *
+ * \return 0 when enabled, -1 on timeout (TCD0 is left disabled).
+ */
+int8_t PWM_TCD_0_enable()
+{
+	uint16_t polls = PWM_TCD_0_ENRDY_TIMEOUT_US;
+	uint8_t  i;
+
+	for (i = 0; i < 4; i++) {
+		(&TCD0.CMPASET)[i] = PWM_TCD_0_shadow[i];
+	}
+	PWM_TCD_0_dirty = 0;
+	while (!(TCD0.STATUS & TCD_ENRDY_bm)) {
+		if (polls-- == 0) {
+			return -1;
+		}
+		_delay_us(1);
+	}
+	TCD0.CTRLA |= TCD_ENABLE_bm;
+
+	return 0;
+}
+
+/**
+ * \brief Disable TCD0, the outputs keep their last level
+ */
+void PWM_TCD_0_disable()
+{
+	TCD0.CTRLA &= ~TCD_ENABLE_bm;
+}
+
+/**
+ * \brief Select one-ramp or two-ramp mode
+ *
+ * CTRLB is enable-protected, so a running timer is stopped for the switch
+ * and restarted with the compare values of the new mode.
+ *
+ * \param[in] mode TCD_WGMODE_ONERAMP_gc or TCD_WGMODE_TWORAMP_gc
+ *
+ * \return 0 on success, -1 for another mode, if the frequency does not fit
+ *         or if the timer could not be restarted.
+ */
+int8_t PWM_TCD_0_set_mode(TCD_WGMODE_t mode)
+{
+	uint8_t enabled = TCD0.CTRLA & TCD_ENABLE_bm;
+	int8_t  ret;
+
+	if (mode != TCD_WGMODE_ONERAMP_gc && mode != TCD_WGMODE_TWORAMP_gc) {
+		return -1;
+	}
+	PWM_TCD_0_disable();
+	TCD0.CTRLB = mode;
+	ret        = PWM_TCD_0_update();
+	if (enabled && PWM_TCD_0_enable() < 0) {
+		return -1;
+	}
+	return ret;
+}
+
+/**
+ * \brief Set the PWM frequency, from the measured OSC20M frequency
+ *
+ * \param[in] hz Output frequency in Hz
+ *
+ * \return 0 on success, -1 if it does not fit the 12-bit counter.
+ */
+int8_t PWM_TCD_0_set_frequency(uint32_t hz)
+{
+	PWM_TCD_0_freq_hz = hz;
+	return PWM_TCD_0_update();
+}
+
+/**
+ * \brief Set the WOA duty cycle in 1/1000 of the time left by the dead times
+ *
+ * WOB is the complement. Clamped so each output is on for at least one count.
+ *
+ * \param[in] permille Duty cycle of WOA, 0 to 1000
+ */
+void PWM_TCD_0_set_duty_permille(uint16_t permille)
+{
+	PWM_TCD_0_duty_pm = permille > 1000 ? 1000 : permille;
+	PWM_TCD_0_update();
+}
+
+/**
+ * \brief Set the dead time between WOA and WOB
+ *
+ * Rounded to TCD counts, 50 ns at 20 MHz and PWM_TCD_0_CNTPRES DIV1.
+ *
+ * \param[in] ns Dead time in nanoseconds
+ */
+void PWM_TCD_0_set_dead_time(uint16_t ns)
+{
+	PWM_TCD_0_dead_ns = ns;
+	PWM_TCD_0_update();
+}
+
+/**
+ * \brief Rescale TCD0 to a new measured CLK_PER
+ *
+ * OSC20M is recovered from CLK_PER through the MCLKCTRLB prescaler.
+ *
+ * \param[in] clk_hz Measured peripheral clock in Hz
+ */
+void PWM_TCD_0_clock_changed(uint32_t clk_hz)
+{
+	if (clk_hz == 0) {
+		return;
+	}
+	PWM_TCD_0_osc_hz = clk_hz * CLKCTRL_prescaler();
+	PWM_TCD_0_update();
+}
+
+/**
+ * \brief Send pending compare values to TCD0 if it can take them
+ *
+ * Never waits: the values are double buffered by TCD0 and output from the
+ * end of the current TCD cycle. Call it from the main loop while it
+ * returns nonzero to flush values set during a synchronization.
+ *
+ * \return 0 when nothing is pending any more
+ */
+uint8_t PWM_TCD_0_flush(void)
+{
+	uint8_t i;
+
+	if (!PWM_TCD_0_dirty || !(TCD0.CTRLA & TCD_ENABLE_bm)) {
+		return PWM_TCD_0_dirty; /* Taken over by PWM_TCD_0_enable() */
+	}
+	if (PWM_TCD_0_update_pending()) {
+		return 1;
+	}
+	for (i = 0; i < 4; i++) {
+		(&TCD0.CMPASET)[i] = PWM_TCD_0_shadow[i];
+	}
+	TCD0.CTRLE      = TCD_SYNCEOC_bm;
+	PWM_TCD_0_dirty = 0;
+	return 0;
+}
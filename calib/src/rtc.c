@@ -36,12 +36,22 @@
  */
 #include <rtc.h>
 
+volatile RTC_0_ovf_t RTC_0_ovf_count;
+
+/** PIT callback */
+rtc_cb_t RTC_0_pit_cb;
+
+/** Armed compare, RTC_0_cmp_cb is NULL when none */
+static rtc_time_t RTC_0_deadline;
+static rtc_cb_t   RTC_0_cmp_cb;
+
 /**
  * \brief Initialize rtc interface
  * \return Initialization status.
  */
 int8_t RTC_0_init()
 {
+	static const init_table_entry_t init[] = {RTC_0_INIT_TABLE};
 
 	while (RTC.STATUS > 0) { /* Wait for all register to be synchronized */
 	}
@@ -50,13 +60,9 @@ int8_t RTC_0_init()
 
 	// RTC.CNT = 0x0; /* Counter: 0x0 */
 
-	RTC.CTRLA = RTC_PRESCALER_DIV1_gc   /* 1 */
-	            | 1 << RTC_RTCEN_bp     /* Enable: enabled */
-	            | 0 << RTC_RUNSTDBY_bp; /* Run In Standby: disabled */
-
 	// RTC.PER = 0xffff; /* Period: 0xffff */
 
-	RTC.CLKSEL = RTC_CLKSEL_TOSC32K_gc; /* 32.768kHz External Crystal Oscillator (XOSC32K) */
+	init_table_apply(init, ARRAY_SIZE(init));
 
 	// RTC.DBGCTRL = 0 << RTC_DBGRUN_bp; /* Run in debug: disabled */
 
@@ -72,3 +78,98 @@ int8_t RTC_0_init()
 
 	return 0;
 }
+
+/**
+ * \brief Call \a cb once the extended time reaches \a deadline
+ *
+ * Replaces the compare set before. RTC.CMP matches the low 16 bits once per
+ * counter wrap, the interrupt ignores the matches before the deadline.
+ * Waits for the CMP write to be synchronized, ~3 RTC clocks (~90 us), so
+ * that the flag of the previous value can be dropped before arming.
+ * The callback runs in the RTC interrupt and may set the next compare.
+ *
+ * \param[in] deadline Extended time, see RTC_0_now()
+ * \param[in] cb       Function to call
+ *
+ * \return 0 if armed, -1 if the deadline is less than RTC_0_CMP_MIN_TICKS
+ *         ahead, or was reached while arming; the callback is then not called.
+ */
+int8_t RTC_0_set_compare(rtc_time_t deadline, rtc_cb_t cb)
+{
+	int8_t ret = 0;
+
+	RTC_0_cancel_compare();
+	if ((rtc_stime_t)(deadline - RTC_0_now()) < RTC_0_CMP_MIN_TICKS) {
+		return -1;
+	}
+
+	while (RTC.STATUS & RTC_CMPBUSY_bm) {
+	}
+	RTC.CMP = (uint16_t)deadline;
+	while (RTC.STATUS & RTC_CMPBUSY_bm) { /* The new CMP is in use once synchronized */
+	}
+
+	ENTER_CRITICAL(A);
+	RTC_0_deadline = deadline;
+	RTC_0_cmp_cb   = cb;
+	RTC.INTFLAGS   = RTC_CMP_bm; /* Drop a match of the previous CMP value */
+	RTC.INTCTRL |= RTC_CMP_bm;
+	/* A match of the new value while waiting was dropped with the old one */
+	if ((rtc_stime_t)(deadline - RTC_0_now()) <= 0) {
+		RTC_0_cancel_compare();
+		ret = -1;
+	}
+	EXIT_CRITICAL(A);
+
+	return ret;
+}
+
+/**
+ * \brief Disarm the compare set by RTC_0_set_compare()
+ */
+void RTC_0_cancel_compare(void)
+{
+	RTC.INTCTRL &= ~RTC_CMP_bm;
+	RTC_0_cmp_cb = NULL;
+}
+
+/**
+ * \brief Compare match, called from the RTC interrupt after the overflow is counted
+ */
+void RTC_0_compare_isr(void)
+{
+	rtc_cb_t cb = RTC_0_cmp_cb;
+
+	if (cb == NULL || (rtc_stime_t)(RTC_0_now() - RTC_0_deadline) < 0) {
+		return; /* Match of the low 16 bits in an earlier wrap */
+	}
+	RTC_0_cancel_compare();
+	cb();
+}
+
+/**
+ * \brief Call \a cb periodically from the PIT
+ *
+ * \param[in] period RTC_PERIOD_CYCn_gc, n RTC clocks between two callbacks
+ * \param[in] cb     Function to call
+ */
+void RTC_0_pit_start(RTC_PERIOD_t period, rtc_cb_t cb)
+{
+	RTC_0_pit_cb = cb;
+	while (RTC.PITSTATUS & RTC_CTRLBUSY_bm) {
+	}
+	RTC.PITCTRLA    = period | 1 << RTC_PITEN_bp;
+	RTC.PITINTFLAGS = RTC_PI_bm;
+	RTC.PITINTCTRL  = RTC_PI_bm;
+}
+
+/**
+ * \brief Stop the PIT and its callback
+ */
+void RTC_0_pit_stop(void)
+{
+	RTC.PITINTCTRL = 0;
+	while (RTC.PITSTATUS & RTC_CTRLBUSY_bm) {
+	}
+	RTC.PITCTRLA = RTC_PERIOD_OFF_gc;
+}